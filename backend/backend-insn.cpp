@@ -125,6 +125,11 @@ namespace insn {
       case MachineOperand::OR_Xmm0: return "%xmm0";
       case MachineOperand::OR_Xmm1: return "%xmm1";
       case MachineOperand::OR_Xmm2: return "%xmm2";
+      case MachineOperand::OR_Xmm3: return "%xmm3";
+      case MachineOperand::OR_Xmm4: return "%xmm4";
+      case MachineOperand::OR_Xmm5: return "%xmm5";
+      case MachineOperand::OR_Xmm6: return "%xmm6";
+      case MachineOperand::OR_Xmm7: return "%xmm7";
       default: break;
       }
 
@@ -137,7 +142,12 @@ namespace insn {
       switch (reg) {
       case MachineOperand::OR_Xmm0:
       case MachineOperand::OR_Xmm1:
-      case MachineOperand::OR_Xmm2: type = MachineOperand::OT_Float; break;
+      case MachineOperand::OR_Xmm2:
+      case MachineOperand::OR_Xmm3:
+      case MachineOperand::OR_Xmm4:
+      case MachineOperand::OR_Xmm5:
+      case MachineOperand::OR_Xmm6:
+      case MachineOperand::OR_Xmm7: type = MachineOperand::OT_Float; break;
       default:                      type = MachineOperand::OT_Int; break;
       }
       return type;
@@ -717,7 +727,7 @@ namespace insn {
       // add $4,%esp
       auto esp = buildRegOperand(MachineOperand::OR_Esp, MachineOperand::OS_32Bit);
       // mark the stack location as in in order to generate movss
-      insns.push_back(buildMovInsn(buildMemOperand(MachineOperand::OR_Esp, MachineOperand::OS_32Bit, 0), val));
+      appendAll(insns, buildMovTemplate(buildMemOperand(MachineOperand::OR_Esp, MachineOperand::OS_32Bit, 0), val)->getInsns());
       insns.push_back(buildAddInsn(buildImmOperand(4), esp));
     }
     return std::make_shared<TemplateInsn>(insns);
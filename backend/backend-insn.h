@@ -23,7 +23,7 @@ namespace insn {
       // x86 standard registers of type int
       OR_Eax, OR_Ebx, OR_Ecx, OR_Edx, OR_Ebp, OR_Esp, OR_Edi, OR_Esi, OR_Eip,
       // sse related registers
-      OR_Xmm0, OR_Xmm1, OR_Xmm2,
+      OR_Xmm0, OR_Xmm1, OR_Xmm2, OR_Xmm3, OR_Xmm4, OR_Xmm5, OR_Xmm6, OR_Xmm7,
       // used for placeholder was specified or e.g. OC_Imm
       OR_Undefined
     };
@@ -0,0 +1,67 @@
+#include "backend/backend-linearscan.h"
+
+namespace backend {
+namespace linearscan {
+  graph::color::Mappings<core::Variable> getRegisterMappings(const core::analysis::intervals::LiveIntervals& intervals,
+    const core::analysis::interference::InterferenceGraph& graph, unsigned numberOfRegisters) {
+    graph::color::Mappings<core::Variable> result;
+    result.reserve(intervals.size());
+    for (const auto& interval : intervals) result.push_back({interval.var, -1, false});
+
+    std::unordered_map<core::VariablePtr, unsigned, target_hash<core::Variable>, target_equal<core::Variable>> index;
+    std::vector<bool> free(numberOfRegisters, true);
+    // intervals holding a register ordered by increasing end
+    std::set<std::pair<unsigned, unsigned>> active;
+    for (unsigned i = 0; i < intervals.size(); ++i) {
+      const auto& current = intervals[i];
+      index[current.var] = i;
+      // release the registers of all intervals which ended before
+      while (!active.empty() && active.begin()->first < current.start) {
+        free[result[active.begin()->second].color] = true;
+        active.erase(active.begin());
+      }
+
+      auto allowed = [&](int reg) { return !graph.isForbidden(i, reg); };
+      int color = -1;
+      if (current.hint) {
+        auto it = index.find(current.hint);
+        if (it != index.end() && result[it->second].color >= 0 && free[result[it->second].color] &&
+            allowed(result[it->second].color))
+          color = result[it->second].color;
+      }
+      for (unsigned reg = 0; color < 0 && reg < numberOfRegisters; ++reg) {
+        if (free[reg] && allowed(reg)) color = reg;
+      }
+      if (color < 0) {
+        // spill the one which lives the longest, maybe the current one itself,
+        // yet only those holding a register the current one may use
+        auto last = active.rbegin();
+        while (last != active.rend() && !allowed(result[last->second].color)) ++last;
+        if (last == active.rend() || last->first <= current.end) {
+          result[i].flag = true;
+          continue;
+        }
+        color = result[last->second].color;
+        result[last->second].color = -1;
+        result[last->second].flag = true;
+        active.erase(std::next(last).base());
+      }
+      free[color] = false;
+      result[i].color = color;
+      active.insert(std::make_pair(current.end, i));
+    }
+    return result;
+  }
+
+  core::analysis::interference::InterferenceGraph getAllocationGraph(
+    const core::analysis::intervals::LiveIntervals& intervals, core::Type::TypeId type, const core::InsnList& insns) {
+    core::analysis::interference::InterferenceGraph result;
+    for (const auto& interval : intervals) result.addVertex(interval.var);
+    for (const auto& insn : insns) {
+      auto source = core::analysis::interference::getCopySource(insn, type);
+      if (source) result.addMove(cast<core::AssignInsn>(insn)->getLhs(), source);
+    }
+    return result;
+  }
+}
+}
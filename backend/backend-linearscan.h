@@ -0,0 +1,27 @@
+#pragma once
+#include "backend/backend-regalloc.h"
+#include "core/analysis/analysis-interference-graph.h"
+#include "core/analysis/analysis-live-intervals.h"
+
+namespace backend {
+namespace linearscan {
+  // linear scan as described by poletto and sarkar: intervals are visited by
+  // increasing start, expired ones release their register and if none is left
+  // the active interval which ends last is spilled. the i-th mapping of the
+  // result belongs to the i-th interval, copies prefer the register of their source
+  // and the forbidden colors of the i-th vertex of the graph are never assigned
+  graph::color::Mappings<core::Variable> getRegisterMappings(const core::analysis::intervals::LiveIntervals& intervals,
+    const core::analysis::interference::InterferenceGraph& graph, unsigned numberOfRegisters);
+  // a vertex for each interval as well as all copies among them, yet no edges at all
+  core::analysis::interference::InterferenceGraph getAllocationGraph(
+    const core::analysis::intervals::LiveIntervals& intervals, core::Type::TypeId type, const core::InsnList& insns);
+
+  class LinearScanBackend : public regalloc::RegAllocBackend {
+  public:
+    LinearScanBackend(core::NodeManager& manager) :
+      RegAllocBackend(manager) {
+      setLinearScan(true);
+    }
+  };
+}
+}
@@ -1,8 +1,10 @@
 #include "core/analysis/analysis.h"
 #include "backend/backend-memory.h"
 #include "core/analysis/analysis-controlflow.h"
+#include "core/analysis/analysis-insn.h"
 #include "core/analysis/analysis-types.h"
 #include "core/arithmetic/arithmetic.h"
+#include <algorithm>
 
 namespace backend {
 namespace memory {
@@ -21,60 +23,72 @@ namespace memory {
         return 4;
       }
     }
-  }
 
-  StackFrame::StackFrame(const core::VariableList& params, const core::VariableList& locals) :
-    params(params), locals(locals) {
-    numOfBytesLocals = 0;
-    // determine the total number of bytes
-    for (const auto& local : locals)
-      numOfBytesLocals += detail::getNumOfBytes(local);
-  }
+    // the storage of the array itself lies within the frame
+    bool isStaticArray(const core::VariablePtr& var) {
+      return core::analysis::types::isArray(var->getType()) &&
+        var->hasParent() && core::analysis::isConstant(var->getParent()->getSize());
+    }
 
-  int StackFrame::getRelativeOffset(const core::VariablePtr& var) const {
-    int result = getRelativeOffsetCached(var);
-    if (result != 0) return result;
+    unsigned getNumOfBytes(const core::VariableList& slot) {
+      unsigned result = 0;
+      for (const auto& var : slot) result = std::max(result, getNumOfBytes(var));
+      return result;
+    }
+  }
 
-    // is it a parameter?
-    auto it = std::find_if(params.begin(), params.end(),
-      [&](const core::VariablePtr& param) { return *param == *var; });
-    if (it != params.end()) {
+  StackFrame::StackFrame(const core::VariableList& params, const SlotList& slots) :
+    params(params) {
+    for (unsigned i = 0; i < params.size(); ++i) {
       // care, the params are stored in-order whereas the stack layout is reverse
-      auto index = std::distance(params.begin(), it);
       // 8 as we need to pass the ret-addr and index eq. 0 is first arg
-      return 8 + index*4;
+      offsets[params[i]] = 8 + i*4;
     }
 
-    // try to find it in the locals list
-    it = std::find_if(locals.begin(), locals.end(),
-      [&](const core::VariablePtr& local) { return *local == *var; });
-    assert(it != locals.end() && "cannot obtain relative offset of variable not bound to stack frame");
+    // scalars come first to keep their displacements short, arrays follow by size
+    SlotList sorted(slots);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const core::VariableList& lhs, const core::VariableList& rhs) {
+      bool lhsArray = detail::isStaticArray(lhs.front());
+      bool rhsArray = detail::isStaticArray(rhs.front());
+      if (lhsArray != rhsArray) return rhsArray;
+      return detail::getNumOfBytes(lhs) < detail::getNumOfBytes(rhs);
+    });
 
-    std::advance(it, 1);
     // care, locals are negative in offset
-    std::for_each(locals.begin(), it, [&](const core::VariablePtr& local) {
-      result -= detail::getNumOfBytes(local);
-    });
-    cache.insert(std::make_pair(var, std::make_shared<int>(result)));
-    return result;
+    int offset = 0;
+    for (const auto& slot : sorted) {
+      offset -= detail::getNumOfBytes(slot);
+      for (const auto& var : slot) {
+        offsets[var] = offset;
+        locals.push_back(var);
+      }
+    }
+    numOfBytesLocals = -offset;
+  }
+
+  int StackFrame::getRelativeOffset(const core::VariablePtr& var) const {
+    auto it = offsets.find(var);
+    assert(it != offsets.end() && "cannot obtain relative offset of variable not bound to stack frame");
+    return it->second;
   }
 
   int StackFrame::getRelativeOffset(insn::MachineOperand::Register reg) const {
-    // scratch is only supported for %edx
+    // scratch is only supported for the caller-saved and the allocatable sse registers
     switch (reg) {
-    case insn::MachineOperand::OR_Edx: return -(4 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Edx:  return -(4 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Xmm2: return -(8 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Xmm3: return -(12 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Xmm4: return -(16 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Xmm5: return -(20 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Xmm6: return -(24 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Xmm7: return -(28 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Ecx:  return -(32 + getNumOfBytesLocals());
+    case insn::MachineOperand::OR_Eax:  return -(36 + getNumOfBytesLocals());
     default: break;
     }
     assert(false && "unsupported scratch register");
   }
 
-  int StackFrame::getRelativeOffsetCached(const core::VariablePtr& var) const {
-    auto it = cache.find(var);
-    // as 0 is the only value that cannot be returned to the user!
-    if (it == cache.end()) return 0;
-    return *(it->second);
-  }
-
   unsigned StackFrame::getNumOfBytesParameters() const {
     return params.size() * 4;
   }
@@ -84,7 +98,8 @@ namespace memory {
   }
 
   unsigned StackFrame::getNumOfBytesScratch() const {
-    return 4;
+    // %edx, %xmm2 - %xmm7, %ecx, %eax
+    return 36;
   }
 
   unsigned StackFrame::getNumOfBytesFrame() const {
@@ -99,7 +114,52 @@ namespace memory {
     for (const auto& param : params)
       locals.erase(param);
 
-    return std::make_shared<StackFrame>(params, core::VariableList(locals.begin(), locals.end()));
+    SlotList slots;
+    for (const auto& local : locals) slots.push_back({ local });
+    return std::make_shared<StackFrame>(params, slots);
+  }
+
+  StackFramePtr getStackFrame(const core::FunctionPtr& fun,
+    const core::analysis::worklist::TwoLevelLiveness& liveness, const core::VariableSet& spilled) {
+    const auto& params = fun->getParameters();
+    auto locals = core::analysis::controlflow::getAllVars(fun, true);
+
+    // remove all params from the locals set
+    for (const auto& param : params)
+      locals.erase(param);
+
+    SlotList slots;
+    core::VariableList scalars;
+    for (const auto& local : locals) {
+      if (detail::isStaticArray(local)) slots.push_back({ local });
+      else if (spilled.count(local)) scalars.push_back(local);
+    }
+
+    // a dead def still writes its slot, thus it interferes as well
+    std::map<core::VariablePtr, core::VariableSet, target_less<core::Variable>> interference;
+    for (const auto& pair : liveness.getNodeData()) {
+      core::VariableSet live;
+      for (const auto& vars : { pair.second->getLiveIn(), pair.second->getLiveOut(),
+        core::analysis::insn::getOutputVars(pair.first) }) {
+        for (const auto& var : vars)
+          if (spilled.count(var)) live.insert(var);
+      }
+      for (const auto& var : live) interference[var].insert(live.begin(), live.end());
+    }
+
+    // each scalar joins the first slot it does not interfere with
+    SlotList shared;
+    for (const auto& scalar : scalars) {
+      const auto& conflicts = interference[scalar];
+      auto it = std::find_if(shared.begin(), shared.end(), [&](const core::VariableList& slot) {
+        return std::none_of(slot.begin(), slot.end(),
+          [&](const core::VariablePtr& var) { return conflicts.count(var) > 0; });
+      });
+      if (it == shared.end()) shared.push_back({ scalar });
+      else it->push_back(scalar);
+    }
+    slots.insert(slots.end(), shared.begin(), shared.end());
+    return std::make_shared<StackFrame>(params, slots);
   }
 }
 }
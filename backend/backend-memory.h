@@ -1,10 +1,14 @@
 #pragma once
 
 #include "core/core.h"
+#include "core/analysis/analysis-live-variable.h"
 #include "backend/backend-insn.h"
 
 namespace backend {
 namespace memory {
+  // the vars of a slot are never live at the same time
+  typedef std::vector<core::VariableList> SlotList;
+
   /**
    * Models variables and their associated stack location
    * high address:
@@ -15,7 +19,8 @@ namespace memory {
    * arg 0
    * ret addr
    * old ebp <-- ebp points here
-   * local vars ...
+   * scalar slots ...
+   * array slots by increasing size ...
    *
    * low address:
    */
@@ -23,10 +28,9 @@ namespace memory {
     core::VariableList params;
     core::VariableList locals;
     unsigned numOfBytesLocals;
-    mutable PtrMap<core::Variable, int> cache;
-    int getRelativeOffsetCached(const core::VariablePtr& var) const;
+    std::map<core::VariablePtr, int, target_less<core::Variable>> offsets;
   public:
-    StackFrame(const core::VariableList& params, const core::VariableList& locals);
+    StackFrame(const core::VariableList& params, const SlotList& slots);
     const core::VariableList& getParameters() const { return params; }
     const core::VariableList& getLocals() const { return locals; }
     unsigned getNumOfBytesParameters() const;
@@ -38,6 +42,11 @@ namespace memory {
   };
   typedef Ptr<StackFrame> StackFramePtr;
 
+  // each local is bound to a slot of its own
   StackFramePtr getStackFrame(const core::FunctionPtr& fun);
+  // binds the arrays of static size and the spilled vars only, the latter share
+  // a slot unless they are live or written at the same insn
+  StackFramePtr getStackFrame(const core::FunctionPtr& fun,
+    const core::analysis::worklist::TwoLevelLiveness& liveness, const core::VariableSet& spilled);
 }
 }
@@ -1,4 +1,5 @@
 #include "backend/backend-regalloc.h"
+#include "backend/backend-linearscan.h"
 #include "backend/backend-memory.h"
 #include "backend/backend-insn.h"
 #include "backend/backend-instrument.h"
@@ -8,8 +9,11 @@
 #include "core/analysis/analysis-callgraph.h"
 #include "core/analysis/analysis-controlflow.h"
 #include "core/analysis/analysis-interference-graph.h"
+#include "core/analysis/analysis-live-intervals.h"
 #include "core/analysis/analysis-live-variable.h"
 #include "core/arithmetic/arithmetic.h"
+#include <algorithm>
+#include <cmath>
 
 namespace backend {
 namespace regalloc {
@@ -35,18 +39,73 @@ namespace regalloc {
       return !isCallerSaved(reg);
     }
 
+    typedef std::set<insn::MachineOperand::Register> RegisterSet;
+
+    // the caller-saved ones come last, as they are clobbered by calls and
+    // used as scratch by the matchers -- see RegAllocMatcher::getClobbers
     insn::MachineOperand::Register mapColor(int color) {
       switch (color) {
       case 0: return insn::MachineOperand::OR_Ebx;
       case 1: return insn::MachineOperand::OR_Edi;
       case 2: return insn::MachineOperand::OR_Esi;
       case 3: return insn::MachineOperand::OR_Edx;
+      case 4: return insn::MachineOperand::OR_Ecx;
+      case 5: return insn::MachineOperand::OR_Eax;
       }
       assert(false && "invalid color to reg mapping");
       return insn::MachineOperand::OR_Eax;
     }
 
-    template<typename Lambda, typename TResult = std::set<insn::MachineOperand::Register>>
+    // -1 if the register is not subject to allocation
+    int getColor(insn::MachineOperand::Register reg) {
+      switch (reg) {
+      case insn::MachineOperand::OR_Ebx: return 0;
+      case insn::MachineOperand::OR_Edi: return 1;
+      case insn::MachineOperand::OR_Esi: return 2;
+      case insn::MachineOperand::OR_Edx: return 3;
+      case insn::MachineOperand::OR_Ecx: return 4;
+      case insn::MachineOperand::OR_Eax: return 5;
+      default: return -1;
+      }
+    }
+
+    // %xmm0 and %xmm1 remain scratch registers
+    insn::MachineOperand::Register mapFloatColor(int color) {
+      switch (color) {
+      case 0: return insn::MachineOperand::OR_Xmm2;
+      case 1: return insn::MachineOperand::OR_Xmm3;
+      case 2: return insn::MachineOperand::OR_Xmm4;
+      case 3: return insn::MachineOperand::OR_Xmm5;
+      case 4: return insn::MachineOperand::OR_Xmm6;
+      case 5: return insn::MachineOperand::OR_Xmm7;
+      }
+      assert(false && "invalid color to reg mapping");
+      return insn::MachineOperand::OR_Xmm0;
+    }
+
+    unsigned countCoalescedMoves(const core::analysis::interference::InterferenceGraph& graph,
+      const graph::color::Mappings<core::Variable>& mappings) {
+      unsigned result = 0;
+      for (const auto& move : graph.getMoves()) {
+        int color = mappings[move.first].color;
+        if (color >= 0 && color == mappings[move.second].color) ++result;
+      }
+      return result;
+    }
+
+    // loads & stores to be expected, each reference of a var without register
+    // is weighted by the frequency of its block
+    double getSpillCosts(core::analysis::interference::InterferenceGraph graph,
+      const graph::color::Mappings<core::Variable>& mappings,
+      const core::FunctionPtr& fun, const core::BasicBlockList& bbs) {
+      core::analysis::interference::setSpillCosts(graph, fun, bbs);
+      double result = 0.0;
+      for (unsigned i = 0; i < mappings.size(); ++i)
+        if (mappings[i].color < 0) result += graph.getWeight(i);
+      return result;
+    }
+
+    template<typename Lambda, typename TResult = RegisterSet>
     TResult mapColors(const graph::color::Mappings<core::Variable>& mappings, Lambda lambda) {
       TResult result;
       // determine, user defined, which registers we need to map
@@ -58,22 +117,124 @@ namespace regalloc {
       }
       return result;
     }
+
+    // registers the code refers to, including the implicit operands of idiv and call
+    RegisterSet getReferencedRegs(const insn::MachineInsnList& insns) {
+      RegisterSet result;
+      for (const auto& insn : insns) {
+        for (const auto& op : { insn->getRhs1(), insn->getRhs2() }) {
+          if (op && (op->isRegister() || op->isMemory())) result.insert(op->getRegister());
+        }
+        switch (insn->getOpcode()) {
+        case insn::MachineInsn::OC_Call:
+            result.insert(insn::MachineOperand::OR_Ecx);
+            // fall-through
+        case insn::MachineInsn::OC_IDiv:
+            result.insert(insn::MachineOperand::OR_Eax);
+            result.insert(insn::MachineOperand::OR_Edx);
+            break;
+        default:
+            break;
+        }
+      }
+      return result;
+    }
+
+    bool isFloatCompare(const core::AssignInsnPtr& assign) {
+      return core::analysis::types::isFloat(assign->getRhs1()->getType()) ||
+             core::analysis::types::isFloat(assign->getRhs2()->getType());
+    }
+  }
+
+  Rematerializable getRematerializable(const core::FunctionPtr& fun, const core::BasicBlockList& bbs) {
+    Rematerializable result;
+    PtrMap<core::Variable, core::Variable> copies;
+    const auto& params = fun->getParameters();
+    for (const auto& bb : bbs) {
+      for (const auto& insn : bb->getInsns()) {
+        if (!core::analysis::insn::isAssignInsn(insn)) continue;
+        auto assign = cast<core::AssignInsn>(insn);
+        const auto& lhs = assign->getLhs();
+        if (!core::analysis::types::isInt(lhs->getType()) && !core::analysis::isOffset(lhs)) continue;
+        // params hold their argument up to the def
+        if (std::find_if(params.begin(), params.end(),
+          [&](const core::VariablePtr& param) { return *param == *lhs; }) != params.end()) continue;
+        // a scalar alloca merely reserves the slot and a store writes the element an
+        // offset points to, neither assigns a value to the var itself
+        unsigned defs = 0;
+        for (const auto& def : lhs->getDefs()) {
+          if (core::analysis::insn::isAllocaInsn(def)) continue;
+          if (core::analysis::insn::isStoreInsn(def) && core::analysis::isOffset(lhs)) continue;
+          ++defs;
+        }
+        if (defs != 1) continue;
+
+        if (assign->isAssign()) {
+          if (core::analysis::isIntConstant(assign->getRhs1())) result[lhs] = assign;
+          else if (!core::analysis::isConstant(assign->getRhs1())) copies[lhs] = cast<core::Variable>(assign->getRhs1());
+        } else if (core::analysis::isOffset(lhs) && assign->getOp() == core::AssignInsn::ADD) {
+          // the base of an array within the static frame is relative to %ebp
+          auto base = cast<core::Variable>(assign->getRhs1());
+          if (base->hasParent() && base->getParent()->isConst() && core::analysis::isIntConstant(assign->getRhs2()))
+            result[lhs] = assign;
+        }
+      }
+    }
+    // a copy of such a var holds the very same value
+    for (bool changed = true; changed; ) {
+      changed = false;
+      for (const auto& copy : copies) {
+        auto it = result.find(copy.second);
+        if (it == result.end() || result.count(copy.first)) continue;
+        result[copy.first] = it->second;
+        changed = true;
+      }
+    }
+    return result;
   }
 
   class RegAllocContext : public PatternContext {
     RegAllocBackend& backend;
     memory::StackFramePtr frame;
+    core::analysis::interference::InterferenceGraph intGraph;
     graph::color::Mappings<core::Variable> intMapping;
-    core::analysis::worklist::InsnLiveness liveness;
+    core::analysis::interference::InterferenceGraph fltGraph;
+    graph::color::Mappings<core::Variable> fltMapping;
+    core::analysis::worklist::TwoLevelLiveness liveness;
+    Rematerializable remats;
   public:
     RegAllocContext(RegAllocBackend& backend) : backend(backend) {}
     const RegAllocBackend& getBackend() const { return backend; }
     const memory::StackFramePtr& getFrame() const { return frame; }
     void setFrame(const memory::StackFramePtr& frame) { this->frame = frame; }
+    const core::analysis::interference::InterferenceGraph& getIntGraph() const { return intGraph; }
     const graph::color::Mappings<core::Variable>& getIntMapping() const { return intMapping; }
-    void setIntMapping(const graph::color::Mappings<core::Variable>& mapping) { intMapping = mapping; }
-    const core::analysis::worklist::InsnLiveness& getLiveness() const { return liveness; }
-    void setLiveness(const core::analysis::worklist::InsnLiveness& liveness) { this->liveness = liveness; }
+    void setIntMapping(const core::analysis::interference::InterferenceGraph& graph,
+      const graph::color::Mappings<core::Variable>& mapping) { intGraph = graph; intMapping = mapping; }
+    // -1 if the variable is not mapped onto a register
+    int getIntColor(const core::VariablePtr& var) const {
+      int index = intGraph.getIndex(var);
+      return index < 0 ? -1 : intMapping[index].color;
+    }
+    const core::analysis::interference::InterferenceGraph& getFltGraph() const { return fltGraph; }
+    const graph::color::Mappings<core::Variable>& getFltMapping() const { return fltMapping; }
+    void setFltMapping(const core::analysis::interference::InterferenceGraph& graph,
+      const graph::color::Mappings<core::Variable>& mapping) { fltGraph = graph; fltMapping = mapping; }
+    // -1 if the variable is not mapped onto a sse register
+    int getFltColor(const core::VariablePtr& var) const {
+      int index = fltGraph.getIndex(var);
+      return index < 0 ? -1 : fltMapping[index].color;
+    }
+    const core::analysis::worklist::TwoLevelLiveness& getLiveness() const { return liveness; }
+    void setLiveness(const core::analysis::worklist::TwoLevelLiveness& liveness) { this->liveness = liveness; }
+    const Rematerializable& getRematerializable() const { return remats; }
+    void setRematerializable(const Rematerializable& remats) { this->remats = remats; }
+    // the def to be repeated in place of a reload, nullptr if var holds a register
+    core::AssignInsnPtr getRematerialization(const core::VariablePtr& var) const {
+      auto it = remats.find(var);
+      if (it == remats.end() || getIntColor(var) >= 0) return nullptr;
+      return it->second;
+    }
   };
 
   class RegAllocMatcher : public PatternMatcher {
@@ -81,6 +242,73 @@ namespace regalloc {
     RegAllocMatcher(const PatternContextPtr& context) : PatternMatcher(context) {}
     RegAllocContextPtr getContext() const { return cast<RegAllocContext>(context); }
 
+    // scratch registers the generated code may overwrite besides the one of the
+    // lhs, operands are kept out of them while the allocator assigns registers
+    virtual detail::RegisterSet getClobbers(const core::InsnPtr& insn) const {
+      return { insn::MachineOperand::OR_Eax };
+    }
+    // the generated code ends with a jump, registers are restored right before
+    virtual bool isTerminator() const { return false; }
+
+    // generates the code of the insn and preserves the registers it actually
+    // refers to as scratch, if they hold values live across it
+    PatternResult generateAndPreserve(const core::InsnPtr& insn) const {
+      auto result = generate(insn);
+      auto regs = getLiveClobbers(insn, result.getInsn()->getInsns());
+      if (regs.empty()) return result;
+
+      insn::MachineInsnList insns;
+      saveRegs(insns, regs);
+      appendAll(insns, result.getInsn()->getInsns());
+      if (isTerminator()) {
+        // mov does not alter any flags, thus the jump still sees the compare
+        auto jump = insns.back();
+        insns.pop_back();
+        restoreRegs(insns, regs);
+        insns.push_back(jump);
+      } else {
+        restoreRegs(insns, regs);
+      }
+      return makeResult(std::make_shared<insn::TemplateInsn>(insns), result.getCount());
+    }
+
+    detail::RegisterSet getLiveClobbers(const core::InsnPtr& insn, const insn::MachineInsnList& code) const {
+      detail::RegisterSet result;
+      const auto& nodeData = getContext()->getLiveness().getNodeData();
+      auto it = nodeData.find(insn);
+      if (it == nodeData.end()) return result;
+      // operands never reside in clobbers, thus any other reference to a
+      // caller-saved register is scratch (callee-saved ones are never used as such)
+      auto refs = detail::getReferencedRegs(code);
+      auto defs = core::analysis::insn::getOutputVars(insn);
+      auto uses = core::analysis::insn::getInputVars(insn);
+      for (const auto& var : it->second->getLiveOut()) {
+        if (defs.find(var) != defs.end() || uses.find(var) != uses.end()) continue;
+        int color = getContext()->getIntColor(var);
+        if (color < 0) continue;
+        auto reg = detail::mapColor(color);
+        if (detail::isCallerSaved(reg) && refs.count(reg)) result.insert(reg);
+      }
+      return result;
+    }
+
+    void saveRegs(insn::MachineInsnList& insns, const detail::RegisterSet& regs) const {
+      const auto& frame = getContext()->getFrame();
+      for (const auto& reg: regs)
+        // move the register to scratch space
+        appendAll(insns, insn::buildMovTemplate(insn::buildRegOperand(reg, insn::MachineOperand::OS_32Bit),
+          insn::buildMemOperand(frame->getRelativeOffset(reg)))->getInsns());
+    }
+
+    void restoreRegs(insn::MachineInsnList& insns, const detail::RegisterSet& regs) const {
+      const auto& frame = getContext()->getFrame();
+      // restore any caller saved regs
+      for (const auto& reg: regs)
+        // move the value from scratch space into the register again
+        appendAll(insns, insn::buildMovTemplate(insn::buildMemOperand(frame->getRelativeOffset(reg)),
+          insn::buildRegOperand(reg, insn::MachineOperand::OS_32Bit))->getInsns());
+    }
+
     insn::TemplateInsnPtr buildFrameEntryTemplate() const {
       const auto& frame = getContext()->getFrame();
       const auto& intMapping = getContext()->getIntMapping();
@@ -95,15 +323,15 @@ namespace regalloc {
       if (getContext()->getBackend().getInstrument())
         insn::TemplateInsn::append(result, instrument::buildInstrumentationEntryTemplate());
       // fetch all parameters which are mapped to registers
-      const auto& params = frame->getParameters();
-      for (const auto& mapping : intMapping) {
-        for (const auto& param : params) {
-          if (*mapping.vertex != *param || mapping.color < 0) continue;
-          // we found it, so fetch now
-          insn::TemplateInsn::append(result, insn::buildMovTemplate(
-            insn::buildMemOperand(frame->getRelativeOffset(param)),
-            insn::buildRegOperand(detail::mapColor(mapping.color), insn::MachineOperand::OS_32Bit)));
-        }
+      for (const auto& param : frame->getParameters()) {
+        bool isFloat = core::analysis::types::isFloat(param->getType());
+        int color = isFloat ? getContext()->getFltColor(param) : getContext()->getIntColor(param);
+        if (color < 0) continue;
+        // we found it, so fetch now
+        insn::TemplateInsn::append(result, insn::buildMovTemplate(
+          insn::buildMemOperand(frame->getRelativeOffset(param)),
+          insn::buildRegOperand(isFloat ? detail::mapFloatColor(color) : detail::mapColor(color),
+            insn::MachineOperand::OS_32Bit)));
       }
       return result;
     }
@@ -143,7 +371,6 @@ namespace regalloc {
 
     insn::MachineOperandPtr mapOperand(insn::MachineInsnList& insns, const core::ValuePtr& value, const MapIngredients& ingredients) const {
       const auto& frame = getContext()->getFrame();
-      const auto& intMapping = getContext()->getIntMapping();
 
       if (core::analysis::isConstant(value)) {
         // ints which are read only can be mapped to imms straight away
@@ -163,18 +390,29 @@ namespace regalloc {
       auto dst = insn::buildRegOperand(reg);
       if (reg == ingredients.intReg) {
         // lookup in register mapping to find an assigned register
-        auto it = std::find_if(intMapping.begin(), intMapping.end(),
-          [&](const auto& mapping) { return *mapping.vertex == *var && mapping.color >= 0; });
-        if (it != intMapping.end()) {
+        int color = getContext()->getIntColor(var);
+        if (color >= 0) {
           // we have a mapping, thus take use of it and return to the user
-          auto src = insn::buildRegOperand(detail::mapColor(it->color), insn::MachineOperand::OS_32Bit);
+          auto src = insn::buildRegOperand(detail::mapColor(color), insn::MachineOperand::OS_32Bit);
           // in case we assure only to read from, return it right away
           if (ingredients.allowReg) return src;
           // generate via std move
           appendAll(insns, insn::buildMovTemplate(src, dst)->getInsns());
           return dst;
         }
+        // compute the value again rather than reloading it
+        auto def = getContext()->getRematerialization(var);
+        if (def) return rematerialize(insns, def, ingredients);
         // default fall-through
+      } else {
+        int color = getContext()->getFltColor(var);
+        if (color >= 0) {
+          // same as above, however within the sse registers
+          auto src = insn::buildRegOperand(detail::mapFloatColor(color), insn::MachineOperand::OS_32Bit);
+          if (ingredients.allowReg) return src;
+          appendAll(insns, insn::buildMovTemplate(src, dst)->getInsns());
+          return dst;
+        }
       }
 
       auto src = insn::buildMemOperand(frame->getRelativeOffset(var));
@@ -184,6 +422,23 @@ namespace regalloc {
       return dst;
     }
 
+    insn::MachineOperandPtr rematerialize(insn::MachineInsnList& insns, const core::AssignInsnPtr& def,
+      const MapIngredients& ingredients) const {
+      auto dst = insn::buildRegOperand(ingredients.intReg);
+      if (def->isAssign()) {
+        // wherever memory is fine an imm is as well, just as for constants of the ir
+        if (ingredients.allowImm && ingredients.allowMem) return insn::buildImmOperand(def->getRhs1());
+        appendAll(insns, insn::buildMovTemplate(insn::buildImmOperand(def->getRhs1()), dst)->getInsns());
+        return dst;
+      }
+      // the element lies at a fixed distance to the base of its array
+      const auto& frame = getContext()->getFrame();
+      int offset = frame->getRelativeOffset(cast<core::Variable>(def->getRhs1())) +
+        core::arithmetic::getValue<int>(def->getRhs2());
+      insns.push_back(insn::buildLeaInsn(insn::buildMemOperand(offset), dst));
+      return dst;
+    }
+
     insn::MachineOperandPtr mapRValue(insn::MachineInsnList& insns, const core::ValuePtr& value,
       insn::MachineOperand::Register intReg, insn::MachineOperand::Register fltReg, bool readOnly = false, bool allowMem = false) const {
       MapIngredients ingredients;
@@ -229,9 +484,10 @@ namespace regalloc {
       bool omit = false;
       const auto& liveness = getContext()->getLiveness();
       if (!liveness.getNodeData().empty()) {
-        const auto& liveOut = liveness.getNodeData().at(insn)->getLiveOut();
-        if (liveOut.find(assign->getLhs()) == liveOut.end()) omit = true;
+        if (!liveness.getNodeData().at(insn)->isLiveOut(assign->getLhs())) omit = true;
       }
+      // each use takes the constant itself
+      if (getContext()->getRematerialization(assign->getLhs())) omit = true;
 
       if (!omit) {
         // generate the target memory operand, this can be done independent of cases
@@ -370,6 +626,13 @@ namespace regalloc {
              (assign->getOp() == core::AssignInsn::SUB);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      auto assign = cast<core::AssignInsn>(insn);
+      // flattened into the lhs, rhs2 is either an imm, a register or a memory location
+      if (*assign->getLhs() == *assign->getRhs1() && core::analysis::isIntConstant(assign->getRhs2())) return {};
+      return { insn::MachineOperand::OR_Eax };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto assign = cast<core::AssignInsn>(insn);
       // expected input:
@@ -414,8 +677,17 @@ namespace regalloc {
              (assign->getOp() == core::AssignInsn::DIV);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      auto assign = cast<core::AssignInsn>(insn);
+      // sse operands may reside in memory, only constants are moved via %eax
+      if (core::analysis::types::isFloat(assign->getRhs2()->getType())) return { insn::MachineOperand::OR_Eax };
+      // idiv divides %edx:%eax
+      if (assign->getOp() == core::AssignInsn::DIV && core::analysis::types::isInt(assign->getRhs2()->getType()))
+        return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx, insn::MachineOperand::OR_Edx };
+      return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
-      const auto& intMapping = getContext()->getIntMapping();
       auto assign = cast<core::AssignInsn>(insn);
       // expected input:
       // {v0,$0} = rhs1 op rhs2
@@ -431,20 +703,7 @@ namespace regalloc {
         core::analysis::types::isFloat(assign->getRhs2()->getType()));
       switch (assign->getOp()) {
       case core::AssignInsn::MUL: appendAll(insns, insn::buildMulTemplate(rhs2, rhs1)->getInsns()); break;
-      case core::AssignInsn::DIV:
-        {
-          bool saveEdx = false;
-          auto edx = insn::buildRegOperand(insn::MachineOperand::OR_Edx, insn::MachineOperand::OS_32Bit);
-          // check if we need to save EDX as idiv clobbers it
-          if (rhs2->isInt()) {
-            auto regs = detail::mapColors(intMapping, &detail::isCallerSaved);
-            saveEdx = regs.find(insn::MachineOperand::OR_Edx) != regs.end();
-          }
-          if (saveEdx) appendAll(insns, insn::buildPushTemplate(edx)->getInsns());
-          appendAll(insns, insn::buildDivTemplate(rhs2, rhs1)->getInsns());
-          if (saveEdx) appendAll(insns, insn::buildPopTemplate(edx)->getInsns());
-          break;
-        }
+      case core::AssignInsn::DIV: appendAll(insns, insn::buildDivTemplate(rhs2, rhs1)->getInsns()); break;
       default:
           assert(false && "unsupported binary operation");
           break;
@@ -465,6 +724,15 @@ namespace regalloc {
       return assign->isBinary() && core::AssignInsn::isLogicalBinaryOp(assign->getOp());
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      auto assign = cast<core::AssignInsn>(insn);
+      // the parity of float (in)equality is evaluated within %ecx
+      if (detail::isFloatCompare(assign) &&
+          (assign->getOp() == core::AssignInsn::EQ || assign->getOp() == core::AssignInsn::NE))
+        return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx };
+      return { insn::MachineOperand::OR_Eax };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto assign = cast<core::AssignInsn>(insn);
       // expected input:
@@ -516,10 +784,20 @@ namespace regalloc {
       // do lhs & cond match?
       if (*fjmp->getCond() != *assign->getLhs()) return false;
       // liveness?
-      const auto& liveOut = liveness.getNodeData().at(fjmp)->getLiveOut();
-      return liveOut.find(cast<core::Variable>(fjmp->getCond())) == liveOut.end();
+      return !liveness.getNodeData().at(fjmp)->isLiveOut(cast<core::Variable>(fjmp->getCond()));
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      auto assign = cast<core::AssignInsn>(insn);
+      // the parity of float (in)equality is evaluated within %ecx
+      if (detail::isFloatCompare(assign) &&
+          (assign->getOp() == core::AssignInsn::EQ || assign->getOp() == core::AssignInsn::NE))
+        return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx };
+      return { insn::MachineOperand::OR_Eax };
+    }
+
+    bool isTerminator() const override { return true; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto assign = cast<core::AssignInsn>(insn);
       // expected input:
@@ -559,12 +837,26 @@ namespace regalloc {
       return core::analysis::isOffset(assign->getLhs());
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       const auto& frame = getContext()->getFrame();
       auto assign = cast<core::AssignInsn>(insn);
       // input can be the following form
       // $0 = v0 + $1
       insn::MachineInsnList insns;
+      if (getContext()->getRematerializable().count(assign->getLhs())) {
+        // a single lea suffices, without a register each use computes the address on its own
+        int color = getContext()->getIntColor(assign->getLhs());
+        if (color >= 0) {
+          MapIngredients ingredients;
+          ingredients.intReg = detail::mapColor(color);
+          rematerialize(insns, assign, ingredients);
+        }
+        return makeResult(std::make_shared<insn::TemplateInsn>(insns));
+      }
       // fetch the address of v0 into eax
       auto rhs1 = assign->getRhs1();
       assert(core::analysis::types::isArray(rhs1->getType()) &&
@@ -600,6 +892,8 @@ namespace regalloc {
       return core::analysis::insn::isReturnInsn(insn);
     }
 
+    bool isTerminator() const override { return true; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto ret = cast<core::ReturnInsn>(insn);
       // input can be the following form
@@ -631,11 +925,17 @@ namespace regalloc {
       return core::analysis::insn::isPushInsn(insn);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override { return {}; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto push = cast<core::PushInsn>(insn);
-      return makeResult(insn::buildPushTemplate(core::analysis::isConstant(push->getRhs()) ?
-        insn::buildImmOperand(push->getRhs()) :
-        mapLValue(cast<core::Variable>(push->getRhs()))));
+      if (core::analysis::isConstant(push->getRhs()))
+        return makeResult(insn::buildPushTemplate(insn::buildImmOperand(push->getRhs())));
+      // the address of an element is computed in %eax, which is preserved if need be
+      insn::MachineInsnList insns;
+      auto src = mapRValue(insns, push->getRhs(), insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Xmm0, true, true);
+      appendAll(insns, insn::buildPushTemplate(src)->getInsns());
+      return makeResult(std::make_shared<insn::TemplateInsn>(insns));
     }
   };
 
@@ -646,6 +946,8 @@ namespace regalloc {
       return core::analysis::insn::isPopInsn(insn);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override { return {}; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto pop = cast<core::PopInsn>(insn);
       // check what type we need to generate
@@ -663,6 +965,8 @@ namespace regalloc {
       return core::analysis::insn::isPushSpInsn(insn);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override { return {}; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto push = cast<core::PushSpInsn>(insn);
 
@@ -691,21 +995,15 @@ namespace regalloc {
   };
 
   class CallMatcher : public RegAllocMatcher {
-    void saveRegs(insn::MachineInsnList& insns, const std::set<insn::MachineOperand::Register>& regs) const {
-      const auto& frame = getContext()->getFrame();
-      for (const auto& reg: regs)
-        // move the register to scratch space
-        appendAll(insns, insn::buildMovTemplate(insn::buildRegOperand(reg, insn::MachineOperand::OS_32Bit),
-          insn::buildMemOperand(frame->getRelativeOffset(reg)))->getInsns());
-    }
-
-    void restoreRegs(insn::MachineInsnList& insns, const std::set<insn::MachineOperand::Register>& regs) const {
-      const auto& frame = getContext()->getFrame();
-      // restore any caller saved regs
-      for (const auto& reg: regs)
-        // move the value from scratch space into the register again
-        appendAll(insns, insn::buildMovTemplate(insn::buildMemOperand(frame->getRelativeOffset(reg)),
-          insn::buildRegOperand(reg, insn::MachineOperand::OS_32Bit))->getInsns());
+    void addLiveFloatRegs(const core::InsnPtr& insn, detail::RegisterSet& regs) const {
+      const auto& nodeData = getContext()->getLiveness().getNodeData();
+      auto it = nodeData.find(insn);
+      if (it == nodeData.end()) return;
+      // all sse registers are caller-saved, thus only preserve those still in use
+      for (const auto& var : it->second->getLiveOut()) {
+        int color = getContext()->getFltColor(var);
+        if (color >= 0) regs.insert(detail::mapFloatColor(color));
+      }
     }
   public:
     using RegAllocMatcher::RegAllocMatcher;
@@ -713,10 +1011,15 @@ namespace regalloc {
       return core::analysis::insn::isCallInsn(insn);
     }
 
+    // the int ones are preserved as any other clobber, the sse ones right here
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx, insn::MachineOperand::OR_Edx };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
-      const auto& intMapping = getContext()->getIntMapping();
       auto call = cast<core::CallInsn>(insn);
-      auto regs = detail::mapColors(intMapping, &detail::isCallerSaved);
+      detail::RegisterSet regs;
+      addLiveFloatRegs(insn, regs);
       if (!core::analysis::insn::hasReturnValue(call)) {
         // simply generate the call and we are done
         insn::MachineInsnList insns;
@@ -731,6 +1034,8 @@ namespace regalloc {
         insn::MachineOperand::Register::OR_Eax : insn::MachineOperand::Register::OR_Xmm0,
         insn::MachineOperand::OS_32Bit);
       auto dst = mapLValue(call->getResult());
+      // the result must not be overwritten by its former value
+      if (!dst->isMemory()) regs.erase(dst->getRegister());
 
       insn::MachineInsnList insns;
       saveRegs(insns, regs);
@@ -749,6 +1054,8 @@ namespace regalloc {
       return core::analysis::insn::isFalseJumpInsn(insn);
     }
 
+    bool isTerminator() const override { return true; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto fjmp = cast<core::FalseJumpInsn>(insn);
       // expected input
@@ -770,6 +1077,10 @@ namespace regalloc {
       return core::analysis::insn::isGotoInsn(insn);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override { return {}; }
+
+    bool isTerminator() const override { return true; }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto ujmp = cast<core::GotoInsn>(insn);
       // expected input
@@ -816,6 +1127,10 @@ namespace regalloc {
       return core::analysis::insn::isStoreInsn(insn);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto store = cast<core::StoreInsn>(insn);
       // expected
@@ -823,7 +1138,7 @@ namespace regalloc {
       insn::MachineInsnList insns;
       auto src = mapRValue(insns, store->getSource(), insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Xmm0, true);
       // dst is a little bit tricky .. handle cases
-      auto dst = mapLValue(store->getTarget());
+      auto dst = mapRValue(insns, store->getTarget(), insn::MachineOperand::OR_Ecx, insn::MachineOperand::OR_Xmm1, true, true);
       // at this point we either hold a register or a memory location of the vN/tN
       if (core::analysis::isOffset(store->getTarget()) && dst->isMemory()) {
         auto ecx = insn::buildRegOperand(insn::MachineOperand::OR_Ecx);
@@ -848,6 +1163,13 @@ namespace regalloc {
       return core::analysis::insn::isAllocaInsn(insn);
     }
 
+    detail::RegisterSet getClobbers(const core::InsnPtr& insn) const override {
+      // only dynamic allocas generate code, the rest are in static frame
+      auto alloca = cast<core::AllocaInsn>(insn);
+      if (!core::analysis::types::isArray(alloca->getVariable()->getType()) || alloca->isConst()) return {};
+      return { insn::MachineOperand::OR_Eax, insn::MachineOperand::OR_Ecx };
+    }
+
     PatternResult generate(const core::InsnPtr& insn) const override {
       auto alloca = cast<core::AllocaInsn>(insn);
       insn::MachineInsnList insns;
@@ -869,8 +1191,8 @@ namespace regalloc {
     }
   };
 
-  RegAllocBackend::RegAllocBackend(const core::ProgramPtr& program) :
-    Backend(program) {
+  RegAllocBackend::RegAllocBackend(core::NodeManager& manager) :
+    Backend(manager) {
     context = std::make_shared<RegAllocContext>(*this);
     matchers.push_back(makeMatcher<PlainAssignMatcher>(context));
     matchers.push_back(makeMatcher<LoadMatcher>(context));
@@ -906,6 +1228,88 @@ namespace regalloc {
     return true;
   }
 
+  void RegAllocBackend::addClobberConstraints(graph::color::AllocationGraph<core::Variable>& graph,
+    const core::InsnList& insns) const {
+    for (const auto& insn : insns) {
+      auto it = std::find_if(matchers.begin(), matchers.end(),
+        [&](const RegAllocMatcherPtr& matcher) { return matcher->matches(insn); });
+      if (it == matchers.end()) continue;
+      // the lhs is written last, thus it may reside within a clobber unless
+      // it is read as well, values live across the insn are kept out of the
+      // clobbers too as preserving them costs a save & restore each time
+      auto clobbers = (*it)->getClobbers(insn);
+      if (clobbers.empty()) continue;
+      auto vars = core::analysis::insn::getInputVars(insn);
+      auto nodeData = context->getLiveness().getNodeData().find(insn);
+      if (nodeData != context->getLiveness().getNodeData().end()) {
+        auto defs = core::analysis::insn::getOutputVars(insn);
+        for (const auto& var : nodeData->second->getLiveOut())
+          if (defs.find(var) == defs.end()) vars.insert(var);
+      }
+      for (const auto& var : vars) {
+        int index = graph.getIndex(var);
+        if (index < 0) continue;
+        for (const auto& reg : clobbers) {
+          int color = detail::getColor(reg);
+          if (color >= 0) graph.forbidColor(index, color);
+        }
+      }
+    }
+  }
+
+  void RegAllocBackend::allocateRegisters(const core::FunctionPtr& fun, const core::BasicBlockList& bbs,
+    const split::Pieces& pieces) {
+    auto insns = core::analysis::controlflow::getLinearInsnList(bbs);
+    // compute liveness information on block level, refined for each insn
+    core::analysis::worklist::TwoLevelLiveness liveness;
+    liveness.apply(fun);
+    // the matchers rely on liveness to determine their clobbers
+    context->setLiveness(liveness);
+    auto remats = getRematerializable(fun, bbs);
+    context->setRematerializable(remats);
+    // a piece has been split off on purpose, coalescing it would undo that
+    auto keepApart = [&](core::analysis::interference::InterferenceGraph& graph) {
+      graph.removeMoves([&](unsigned source, unsigned target) {
+        const auto& lhs = graph.getVertex(source);
+        const auto& rhs = graph.getVertex(target);
+        auto it = pieces.find(lhs);
+        if (it != pieces.end() && *it->second == *rhs) return true;
+        it = pieces.find(rhs);
+        return it != pieces.end() && *it->second == *lhs;
+      });
+    };
+    core::analysis::interference::InterferenceGraph intGraph, fltGraph;
+    if (getLinearScan()) {
+      // a single pass over the live intervals instead of building the graphs
+      auto intIntervals = core::analysis::intervals::getLiveIntervals(fun, core::Type::TI_Int, liveness, bbs);
+      auto fltIntervals = core::analysis::intervals::getLiveIntervals(fun, core::Type::TI_Float, liveness, bbs);
+      intGraph = linearscan::getAllocationGraph(intIntervals, core::Type::TI_Int, insns);
+      fltGraph = linearscan::getAllocationGraph(fltIntervals, core::Type::TI_Float, insns);
+      keepApart(intGraph);
+      keepApart(fltGraph);
+      addClobberConstraints(intGraph, insns);
+      context->setIntMapping(intGraph, linearscan::getRegisterMappings(intIntervals, intGraph, intColors));
+      context->setFltMapping(fltGraph, linearscan::getRegisterMappings(fltIntervals, fltGraph, fltColors));
+    } else {
+      // use the liveness to compute the registers
+      intGraph = core::analysis::interference::getInterferenceGraph(fun, core::Type::TI_Int, liveness, insns);
+      fltGraph = core::analysis::interference::getInterferenceGraph(fun, core::Type::TI_Float, liveness, insns);
+      // prefer to keep vars within loops in registers
+      core::analysis::interference::setSpillCosts(intGraph, fun, bbs);
+      core::analysis::interference::setSpillCosts(fltGraph, fun, bbs);
+      // a mov or lea per use is still cheaper than a reload, thus spill those first
+      for (const auto& remat : remats) {
+        int index = intGraph.getIndex(remat.first);
+        if (index >= 0) intGraph.setWeight(index, intGraph.getWeight(index) / 4);
+      }
+      keepApart(intGraph);
+      keepApart(fltGraph);
+      addClobberConstraints(intGraph, insns);
+      context->setIntMapping(intGraph, graph::color::getColorMappings(intGraph, intColors));
+      context->setFltMapping(fltGraph, graph::color::getColorMappings(fltGraph, fltColors));
+    }
+  }
+
   bool RegAllocBackend::convert(std::stringstream& ss, const core::FunctionPtr &fun) {
     std::string name = mangle::demangle(fun->getName());
 
@@ -922,16 +1326,43 @@ namespace regalloc {
     // compute the new context
     context->setFrame(memory::getStackFrame(fun));
     if (getRegAlloc()) {
-      auto insns = core::analysis::controlflow::getLinearInsnList(bbs);
-      // use insns to compute liveness information
-      core::analysis::worklist::InsnLiveness liveness;
-      liveness.apply(insns.begin(), insns.end());
-      // use the liveness to compute the registers
-      context->setIntMapping(graph::color::getColorMappings(
-        core::analysis::interference::getInterferenceGraph(fun, core::Type::TI_Int, liveness, insns),
-        // use four colors, atm we map temporaries onto EBX, EDI and ESI & EDX as special case
-        4));
-      context->setLiveness(liveness);
+      allocateRegisters(fun, bbs, {});
+      // vars without any register are split at loops and calls, thus each
+      // piece competes for a register on its own within a second round.
+      // rematerialized ones are not reloaded anyway
+      core::VariableSet spilled;
+      for (const auto& mappings : { context->getIntMapping(), context->getFltMapping() }) {
+        for (const auto& mapping : mappings)
+          if (mapping.color < 0 && !context->getRematerializable().count(mapping.vertex)) spilled.insert(mapping.vertex);
+      }
+      auto getCosts = [&]() {
+        return detail::getSpillCosts(context->getIntGraph(), context->getIntMapping(), fun, bbs) +
+               detail::getSpillCosts(context->getFltGraph(), context->getFltMapping(), fun, bbs);
+      };
+      double costs = getCosts();
+      auto pieces = split::splitLiveRanges(getManager(), fun, bbs, context->getLiveness(), spilled);
+      if (!pieces.empty()) {
+        allocateRegisters(fun, bbs, pieces);
+        // the pieces may just as well be spilled again, which adds the copies on top
+        if (getCosts() >= costs) {
+          split::joinLiveRanges(pieces);
+          allocateRegisters(fun, bbs, {});
+        }
+      }
+      // only the vars which are neither held in registers nor rematerialized need a slot
+      core::VariableSet slots;
+      for (const auto& var : core::analysis::controlflow::getAllVars(fun, true)) {
+        if (context->getIntColor(var) < 0 && context->getFltColor(var) < 0 &&
+            !context->getRematerialization(var)) slots.insert(var);
+      }
+      context->setFrame(memory::getStackFrame(fun, context->getLiveness(), slots));
+      const auto& intGraph = context->getIntGraph();
+      const auto& fltGraph = context->getFltGraph();
+      // copies between vars of the same register are not emitted at all
+      ss << "# removed "
+         << detail::countCoalescedMoves(intGraph, context->getIntMapping()) +
+            detail::countCoalescedMoves(fltGraph, context->getFltMapping())
+         << " of " << intGraph.getMoves().size() + fltGraph.getMoves().size() << " moves" << std::endl;
     }
     bool first = true;
     // generate each block
@@ -953,7 +1384,7 @@ namespace regalloc {
         for (const auto& matcher : matchers) {
           if (!matcher->matches(insn)) continue;
 
-          auto result = matcher->generate(insn);
+          auto result = matcher->generateAndPreserve(insn);
           result.getInsn()->printTo(ss << std::endl);
           ss << std::endl;
           found = true;
@@ -2,6 +2,7 @@
 #include "backend/backend.h"
 #include "backend/backend-memory.h"
 #include "backend/backend-insn.h"
+#include "backend/backend-split.h"
 #include "utils/utils-graph-color.h"
 
 namespace backend {
@@ -12,16 +13,31 @@ namespace regalloc {
   class RegAllocMatcher;
   typedef Ptr<RegAllocMatcher> RegAllocMatcherPtr;
 
+  // all six gprs, %eax, %ecx & %edx are kept clear of the operands clobbering them
+  const unsigned intColors = 6;
+  // %xmm2 - %xmm7, as %xmm0 and %xmm1 are used as scratch
+  const unsigned fltColors = 6;
+
+  // int vars defined once by a constant or the address of an element of a
+  // static array, mapped onto that def. without a register their value is
+  // computed again by a mov resp. lea on each use instead of being reloaded
+  typedef PtrMap<core::Variable, core::AssignInsn> Rematerializable;
+  Rematerializable getRematerializable(const core::FunctionPtr& fun, const core::BasicBlockList& bbs);
+
   class RegAllocBackend : public Backend {
     std::string targetCode;
     RegAllocContextPtr context;
   public:
-    RegAllocBackend(const core::ProgramPtr& program);
+    RegAllocBackend(core::NodeManager& manager);
     bool convert() override;
     std::ostream& printTo(std::ostream& stream) const override;
     const RegAllocContextPtr& getContext() const { return context; }
   private:
     bool convert(std::stringstream& ss, const core::FunctionPtr& fun);
+    // keeps the operands of each insn out of the registers its matcher clobbers
+    void addClobberConstraints(graph::color::AllocationGraph<core::Variable>& graph, const core::InsnList& insns) const;
+    // maps the vars of fun onto registers, copies among pieces and their origin are not coalesced
+    void allocateRegisters(const core::FunctionPtr& fun, const core::BasicBlockList& bbs, const split::Pieces& pieces);
     std::vector<RegAllocMatcherPtr> matchers;
   };
 }
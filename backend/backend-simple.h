@@ -5,8 +5,8 @@ namespace backend {
 namespace simple {
   class SimpleBackend : public regalloc::RegAllocBackend {
   public:
-    SimpleBackend(const core::ProgramPtr& program) :
-      RegAllocBackend(program) {
+    SimpleBackend(core::NodeManager& manager) :
+      RegAllocBackend(manager) {
       setRegAlloc(false);
     }
   };
@@ -0,0 +1,252 @@
+#include "backend/backend-split.h"
+#include "core/analysis/analysis.h"
+#include "core/analysis/analysis-controlflow.h"
+#include "core/analysis/analysis-insn.h"
+#include "core/analysis/analysis-loop.h"
+#include "core/analysis/analysis-types.h"
+#include <algorithm>
+#include <map>
+
+namespace backend {
+namespace split {
+  namespace detail {
+    bool contains(const core::BasicBlockList& bbs, const core::BasicBlockPtr& bb) {
+      return std::find_if(bbs.begin(), bbs.end(),
+        [&](const core::BasicBlockPtr& cur) { return *cur == *bb; }) != bbs.end();
+    }
+
+    bool reads(const core::InsnPtr& insn, const core::VariablePtr& var) {
+      return core::analysis::insn::getInputVars(insn).count(var) > 0;
+    }
+
+    bool writes(const core::InsnPtr& insn, const core::VariablePtr& var) {
+      // a scalar alloca only reserves the slot of var, no code is generated for it
+      if (core::analysis::insn::isAllocaInsn(insn)) return false;
+      return core::analysis::insn::getOutputVars(insn).count(var) > 0;
+    }
+
+    bool references(const core::InsnPtr& insn, const core::VariablePtr& var) {
+      return reads(insn, var) || writes(insn, var);
+    }
+
+    // only those insns are renamed whose definitions can be redirected as well
+    bool canRename(const core::InsnPtr& insn) {
+      switch (insn->getInsnType()) {
+      case core::Insn::IT_Assign:
+      case core::Insn::IT_FalseJump:
+      case core::Insn::IT_Return:
+      case core::Insn::IT_Push:
+      case core::Insn::IT_Load:
+      case core::Insn::IT_Store:
+        return true;
+      default:
+        return false;
+      }
+    }
+
+    void rename(const core::InsnPtr& insn, const core::VariablePtr& var, const core::VariablePtr& piece) {
+      if (core::analysis::insn::isAssignInsn(insn)) {
+        auto assign = cast<core::AssignInsn>(insn);
+        if (*assign->getLhs() == *var) assign->setLhs(piece);
+      } else if (insn->getInsnType() == core::Insn::IT_Load) {
+        auto load = cast<core::LoadInsn>(insn);
+        if (*load->getTarget() == *var) load->setTarget(piece);
+      }
+      if (reads(insn, var)) insn->replaceNode(var, piece);
+    }
+
+    bool isCopy(const core::InsnPtr& insn, const core::VariablePtr& lhs, const core::VariablePtr& rhs) {
+      if (!core::analysis::insn::isAssignInsn(insn)) return false;
+      auto assign = cast<core::AssignInsn>(insn);
+      return assign->isAssign() && *assign->getLhs() == *lhs && *assign->getRhs1() == *rhs;
+    }
+
+    bool hasCall(const core::BasicBlockList& bbs) {
+      for (const auto& bb : bbs) {
+        for (const auto& insn : bb->getInsns())
+          if (core::analysis::insn::isCallInsn(insn)) return true;
+      }
+      return false;
+    }
+
+    class Splitter {
+      core::NodeManager& manager;
+      const core::FunctionPtr& fun;
+      const core::analysis::worklist::TwoLevelLiveness& liveness;
+      Pieces& pieces;
+      // copies are prepended to blocks, hence live in is taken before any split
+      std::map<core::BasicBlockPtr, core::VariableSet> liveIn;
+    public:
+      Splitter(core::NodeManager& manager, const core::FunctionPtr& fun, const core::BasicBlockList& bbs,
+        const core::analysis::worklist::TwoLevelLiveness& liveness, Pieces& pieces) :
+        manager(manager), fun(fun), liveness(liveness), pieces(pieces) {
+        for (const auto& bb : bbs) {
+          if (!bb->getInsns().empty())
+            liveIn[bb] = liveness.getNodeData().at(bb->getInsns().front())->getLiveIn();
+        }
+      }
+
+      void splitLoops(const core::analysis::loop::LoopList& loops, const core::VariablePtr& var) {
+        for (const auto& loop : loops) {
+          // the outermost call free loop wins, nested ones are covered by it
+          if (!hasCall(loop->getBasicBlocks()) && splitLoop(loop->getBasicBlocks(), var)) continue;
+          splitLoops(loop->getChildren(), var);
+        }
+      }
+
+      void splitCalls(const core::BasicBlockPtr& bb, const core::VariablePtr& var) {
+        core::InsnList run;
+        for (const auto& insn : bb->getInsns()) {
+          // copies of a split loop are left as they are, thus they end a run as well
+          bool copy = !liveness.getNodeData().count(insn);
+          if (!core::analysis::insn::isCallInsn(insn) && !copy) {
+            if (references(insn, var)) run.push_back(insn);
+            continue;
+          }
+          splitRun(run, var);
+          run.clear();
+        }
+        splitRun(run, var);
+      }
+    private:
+      // a fresh temporary, thus a piece never aliases another var of the program
+      core::VariablePtr makePiece(const core::VariablePtr& var) {
+        return manager.buildTemporary(var->getType());
+      }
+
+      core::InsnPtr makeCopy(const core::VariablePtr& lhs, const core::VariablePtr& rhs) {
+        return manager.buildAssign(lhs, rhs);
+      }
+
+      bool splitLoop(const core::BasicBlockList& bbs, const core::VariablePtr& var) {
+        core::InsnList refs;
+        bool modified = false;
+        for (const auto& bb : bbs) {
+          for (const auto& insn : bb->getInsns()) {
+            if (!references(insn, var)) continue;
+            if (!canRename(insn)) return false;
+            refs.push_back(insn);
+            modified |= writes(insn, var);
+          }
+        }
+        if (refs.empty()) return false;
+
+        // a single preheader is required, which enters the loop unconditionally
+        core::BasicBlockPtr header, preheader;
+        for (const auto& bb : bbs) {
+          for (const auto& pred : core::analysis::controlflow::getPredecessors(fun, bb)) {
+            if (contains(bbs, pred)) continue;
+            if (header || !liveIn.count(bb)) return false;
+            header = bb;
+            preheader = pred;
+          }
+        }
+        if (!header || core::analysis::controlflow::getSuccessors(fun, preheader).size() != 1) return false;
+        // copies back are placed on top of the exits, hence they must not be shared
+        core::BasicBlockList exits;
+        for (const auto& bb : bbs) {
+          for (const auto& succ : core::analysis::controlflow::getSuccessors(fun, bb)) {
+            if (contains(bbs, succ) || contains(exits, succ)) continue;
+            if (!liveIn.count(succ)) return false;
+            for (const auto& pred : core::analysis::controlflow::getPredecessors(fun, succ))
+              if (!contains(bbs, pred)) return false;
+            exits.push_back(succ);
+          }
+        }
+
+        auto piece = makePiece(var);
+        bool entry = liveIn[header].count(var) > 0;
+        core::BasicBlockList back;
+        for (const auto& exit : exits)
+          if (modified && liveIn[exit].count(var)) back.push_back(exit);
+        for (const auto& insn : refs) rename(insn, var, piece);
+
+        if (entry) {
+          const auto& insns = preheader->getInsns();
+          auto pos = insns.end();
+          if (!insns.empty() && core::analysis::insn::isGotoInsn(insns.back())) --pos;
+          core::BasicBlock::insert(preheader, pos, makeCopy(piece, var));
+        }
+        for (const auto& exit : back) core::BasicBlock::prepend(exit, makeCopy(var, piece));
+        pieces.insert(std::make_pair(piece, var));
+        return true;
+      }
+
+      void splitRun(const core::InsnList& refs, const core::VariablePtr& var) {
+        // a single reference does not pay off the copies
+        if (refs.size() < 2) return;
+        for (const auto& insn : refs)
+          if (!canRename(insn)) return;
+
+        core::InsnPtr last;
+        for (const auto& insn : refs)
+          if (writes(insn, var)) last = insn;
+        bool entry = reads(refs.front(), var);
+        bool exit = last && liveness.getNodeData().at(last)->isLiveOut(var);
+
+        auto piece = makePiece(var);
+        for (const auto& insn : refs) rename(insn, var, piece);
+        if (entry) {
+          const auto& front = refs.front();
+          core::BasicBlock::insert(front->getParent(), core::BasicBlock::getPosition(front), makeCopy(piece, var));
+        }
+        if (exit) {
+          auto pos = core::BasicBlock::getPosition(last);
+          core::BasicBlock::insert(last->getParent(), ++pos, makeCopy(var, piece));
+        }
+        pieces.insert(std::make_pair(piece, var));
+      }
+    };
+  }
+
+  Pieces splitLiveRanges(core::NodeManager& manager, const core::FunctionPtr& fun, const core::BasicBlockList& bbs,
+    const core::analysis::worklist::TwoLevelLiveness& liveness, const core::VariableSet& vars) {
+    Pieces result;
+    if (vars.empty()) return result;
+    auto loops = core::analysis::loop::findLoops(manager, fun, bbs, false);
+
+    // only vars which are live across a call are restricted to the callee-saved
+    // registers, the pieces in between are not. others are spilled due to pressure
+    core::VariableSet calls;
+    for (const auto& bb : bbs) {
+      for (const auto& insn : bb->getInsns()) {
+        if (!core::analysis::insn::isCallInsn(insn)) continue;
+        auto defs = core::analysis::insn::getOutputVars(insn);
+        for (const auto& var : liveness.getNodeData().at(insn)->getLiveOut())
+          if (!defs.count(var)) calls.insert(var);
+      }
+    }
+
+    detail::Splitter splitter(manager, fun, bbs, liveness, result);
+    for (const auto& var : vars) {
+      if (!calls.count(var)) continue;
+      // arrays and offsets are addresses which are not subject to splitting
+      if (core::analysis::isOffset(var) || core::analysis::types::isArray(var->getType())) continue;
+      splitter.splitLoops(loops, var);
+      // renamed references within loops are not visited again
+      for (const auto& bb : bbs) {
+        if (detail::hasCall({bb})) splitter.splitCalls(bb, var);
+      }
+    }
+    return result;
+  }
+
+  void joinLiveRanges(const Pieces& pieces) {
+    for (const auto& pair : pieces) {
+      const auto& piece = pair.first;
+      const auto& var = pair.second;
+      // the lists of the piece shrink while renaming, thus work on a copy
+      core::InsnList refs(piece->getDefs());
+      refs.insert(refs.end(), piece->getUses().begin(), piece->getUses().end());
+      for (const auto& insn : refs) {
+        // the copy of a def which is a use as well is visited twice
+        if (!insn->isLinked()) continue;
+        if (detail::isCopy(insn, piece, var) || detail::isCopy(insn, var, piece))
+          core::BasicBlock::remove(insn->getParent(), core::BasicBlock::getPosition(insn));
+        else
+          detail::rename(insn, piece, var);
+      }
+    }
+  }
+}
+}
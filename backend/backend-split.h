@@ -0,0 +1,22 @@
+#pragma once
+#include "core/core.h"
+#include "core/analysis/analysis-live-variable.h"
+
+namespace backend {
+namespace split {
+  // each piece of a split live range mapped onto the var it originates from
+  typedef PtrMap<core::Variable, core::Variable> Pieces;
+
+  // splits the live ranges of the given vars, usually those which did not
+  // receive a register at all. the references within each outermost call free
+  // loop are renamed to a fresh var, which is copied from the original one in
+  // the preheader and back on each exit in case the loop modifies it. the same
+  // applies to runs of insns between calls within a block, as long as they
+  // refer to the var at least twice. none of the pieces lives across a call.
+  // pieces and copies are built by manager, each piece is a fresh temporary
+  Pieces splitLiveRanges(core::NodeManager& manager, const core::FunctionPtr& fun, const core::BasicBlockList& bbs,
+    const core::analysis::worklist::TwoLevelLiveness& liveness, const core::VariableSet& vars);
+  // reverts splitLiveRanges, all copies are removed and the pieces renamed back
+  void joinLiveRanges(const Pieces& pieces);
+}
+}
@@ -1,6 +1,7 @@
 #include "backend/backend.h"
 #include "backend/backend-simple.h"
 #include "backend/backend-regalloc.h"
+#include "backend/backend-linearscan.h"
 #include "core/analysis/analysis-interference-graph.h"
 #include "core/analysis/analysis-callgraph.h"
 #include "core/analysis/analysis-live-variable.h"
@@ -12,16 +13,20 @@ namespace backend {
     return {insn, count};
   }
 
-  BackendPtr makeSimpleBackend(const core::ProgramPtr& program) {
-    return std::make_shared<simple::SimpleBackend>(program);
+  BackendPtr makeSimpleBackend(core::NodeManager& manager) {
+    return std::make_shared<simple::SimpleBackend>(manager);
   }
 
-  BackendPtr makeRegAllocBackend(const core::ProgramPtr& program) {
-    return std::make_shared<regalloc::RegAllocBackend>(program);
+  BackendPtr makeRegAllocBackend(core::NodeManager& manager) {
+    return std::make_shared<regalloc::RegAllocBackend>(manager);
   }
 
-  BackendPtr makeDefaultBackend(const core::ProgramPtr& program) {
-    return makeRegAllocBackend(program);
+  BackendPtr makeLinearScanBackend(core::NodeManager& manager) {
+    return std::make_shared<linearscan::LinearScanBackend>(manager);
+  }
+
+  BackendPtr makeDefaultBackend(core::NodeManager& manager) {
+    return makeRegAllocBackend(manager);
   }
 
   namespace {
@@ -37,15 +42,15 @@ namespace backend {
 
     bool dumpTo(const std::string& file, const core::FunctionPtr& fun) {
       auto insns = core::analysis::controlflow::getLinearInsnList(fun);
-      // use insns to generate the liveness information
-      core::analysis::worklist::InsnLiveness liveness;
-      liveness.apply(insns.begin(), insns.end());
+      // generate the liveness information of all insns
+      core::analysis::worklist::TwoLevelLiveness liveness;
+      liveness.apply(fun);
       auto graph = core::analysis::interference::getInterferenceGraph(fun, core::Type::TI_Int, liveness, insns);
-      // use 4 colors as the backend-regalloc does so as well
-      auto color = graph::color::getColorMappings(graph, 4);
+      // use as many colors as the backend-regalloc does for int vars
+      auto color = graph::color::getColorMappings(graph, regalloc::intColors);
 
       std::stringstream ss;
-      core::analysis::interference::InterferenceGraphPrinter(graph, color).printTo(ss);
+      core::analysis::interference::InterferenceGraphPrinter(graph.toColorGraph(), color).printTo(ss);
       return dumpTo(file, ss.str());
     }
   }
@@ -14,19 +14,25 @@ namespace insn {
   typedef Ptr<PatternContext> PatternContextPtr;
 
   class Backend : public Printable {
+    core::NodeManager& manager;
     core::ProgramPtr program;
     bool instrument;
     bool regalloc;
+    bool linearscan;
   public:
     virtual bool convert() = 0;
+    // vars and insns introduced while lowering are built by the manager of the program
+    core::NodeManager& getManager() const { return manager; }
     const core::ProgramPtr& getProgram() const { return program; }
     void setInstrument(bool enable) { instrument = enable; }
     bool getInstrument() const { return instrument; }
     void setRegAlloc(bool enable) { regalloc = enable; }
     bool getRegAlloc() const { return regalloc; }
+    void setLinearScan(bool enable) { linearscan = enable; }
+    bool getLinearScan() const { return linearscan; }
   protected:
-    Backend(const core::ProgramPtr& program) :
-      program(program), instrument(false), regalloc(true)
+    Backend(core::NodeManager& manager) :
+      manager(manager), program(manager.getProgram()), instrument(false), regalloc(true), linearscan(false)
     { }
   };
 
@@ -52,7 +58,8 @@ namespace insn {
   };
 
   bool dumpTo(const BackendPtr& backend, const std::string& dir);
-  BackendPtr makeSimpleBackend(const core::ProgramPtr& program);
-  BackendPtr makeRegAllocBackend(const core::ProgramPtr& program);
-  BackendPtr makeDefaultBackend(const core::ProgramPtr& program);
+  BackendPtr makeSimpleBackend(core::NodeManager& manager);
+  BackendPtr makeRegAllocBackend(core::NodeManager& manager);
+  BackendPtr makeLinearScanBackend(core::NodeManager& manager);
+  BackendPtr makeDefaultBackend(core::NodeManager& manager);
 }
@@ -0,0 +1,122 @@
+#include "core/analysis/analysis-available-expressions.h"
+#include "core/analysis/analysis-insn.h"
+
+namespace core {
+namespace analysis {
+namespace worklist {
+	namespace {
+		bool isExpression(const InsnPtr& insn) {
+			auto assign = dyn_cast<AssignInsn>(insn);
+			// scalar operands are only modified by insns which output them, stores
+			// and calls cannot alias them as they only reach array elements
+			return assign && !assign->isAssign();
+		}
+
+		struct expression_hash {
+			size_t operator()(const AssignInsnPtr& assign) const {
+				std::hash<Value> hash;
+				size_t rhs2 = assign->getRhs2() ? hash(*assign->getRhs2()) : 0;
+				return combine_hash(static_cast<size_t>(assign->getOp()), hash(*assign->getRhs1()), rhs2);
+			}
+		};
+
+		struct expression_equal {
+			bool operator()(const AssignInsnPtr& lhs, const AssignInsnPtr& rhs) const {
+				if (lhs->getOp() != rhs->getOp()) return false;
+				if (*lhs->getRhs1() != *rhs->getRhs1()) return false;
+				if (!lhs->getRhs2() || !rhs->getRhs2()) return !lhs->getRhs2() && !rhs->getRhs2();
+				return *lhs->getRhs2() == *rhs->getRhs2();
+			}
+		};
+	}
+
+	void AvailableExpressions::init() {
+		numbering = numbering::VariableNumbering(fun);
+		expressions.clear();
+		genKill.clear();
+
+		// number all distinct expressions and remember which ones use a variable
+		std::unordered_map<AssignInsnPtr, unsigned, expression_hash, expression_equal> ids;
+		std::unordered_map<InsnPtr, unsigned> idOfInsn;
+		std::vector<BitSet> usersOfVar(numbering.size());
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (const auto& insn : bb->getInsns()) {
+				if (!isExpression(insn)) continue;
+				auto assign = cast<AssignInsn>(insn);
+				auto res = ids.insert(std::make_pair(assign, expressions.size()));
+				idOfInsn.insert(std::make_pair(insn, res.first->second));
+				if (!res.second) continue;
+
+				expressions.push_back(assign);
+				for (const auto& operand : { assign->getRhs1(), assign->getRhs2() }) {
+					auto var = dyn_cast<Variable>(operand);
+					if (!var) continue;
+					unsigned varId = numbering.getId(var);
+					if (varId >= usersOfVar.size()) usersOfVar.resize(varId + 1);
+					usersOfVar[varId].insert(res.first->second);
+				}
+			}
+		}
+
+		for (const auto& bb : fun->getBasicBlocks()) {
+			BitSet gen(expressions.size());
+			BitSet kill(expressions.size());
+			for (const auto& insn : bb->getInsns()) {
+				auto it = idOfInsn.find(insn);
+				if (it != idOfInsn.end()) gen.insert(it->second);
+				// redefining an operand invalidates all expressions using it
+				for (const auto& var : insn::getOutputVars(insn)) {
+					unsigned varId = numbering.getId(var);
+					if (varId >= usersOfVar.size()) continue;
+					gen -= usersOfVar[varId];
+					kill |= usersOfVar[varId];
+				}
+			}
+			genKill[bb] = std::make_pair(gen, kill);
+		}
+	}
+
+	BitSet AvailableExpressions::top() const {
+		return BitSet::full(expressions.size());
+	}
+
+	BitSet AvailableExpressions::boundary() const {
+		// nothing is available at the entry of the function
+		return BitSet(expressions.size());
+	}
+
+	void AvailableExpressions::meet(BitSet& result, const BitSet& fact) const {
+		result &= fact;
+	}
+
+	BitSet AvailableExpressions::transfer(const node_type& bb, const BitSet& fact) {
+		const auto& sets = genKill.at(bb);
+		// out = gen + (in - kill)
+		BitSet result = fact;
+		result -= sets.second;
+		result |= sets.first;
+		return result;
+	}
+
+	AvailableExpressions::node_list_type AvailableExpressions::getSuccessors(const node_type& bb) const {
+		return controlflow::getSuccessors(fun, bb);
+	}
+
+	PtrList<AssignInsn> AvailableExpressions::toExpressionList(const FactMap<BasicBlock, BitSet>& map, const BasicBlockPtr& bb) const {
+		PtrList<AssignInsn> result;
+		auto it = map.find(bb);
+		if (it == map.end()) return result;
+		it->second.forEach([&](size_t id) { result.push_back(expressions[id]); });
+		return result;
+	}
+
+	PtrList<AssignInsn> AvailableExpressions::getExpressionsIn(const BasicBlockPtr& bb) const {
+		return toExpressionList(in, bb);
+	}
+
+	PtrList<AssignInsn> AvailableExpressions::getExpressionsOut(const BasicBlockPtr& bb) const {
+		return toExpressionList(out, bb);
+	}
+}
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "core/core.h"
+#include "core/analysis/analysis-worklist.h"
+#include "core/analysis/analysis-numbering.h"
+
+namespace core {
+namespace analysis {
+namespace worklist {
+	// forward must-problem: which expressions (unary & binary assignments) have
+	// been computed on every path to the entry resp. exit of a basic block
+	// without any of their operands being redefined since
+	class AvailableExpressions : public WorklistAlgorithm<BasicBlock, BitSet> {
+		FunctionPtr fun;
+		numbering::VariableNumbering numbering;
+		// first occurrence of each distinct expression, indexed by its dense id
+		PtrList<AssignInsn> expressions;
+		FactMap<BasicBlock, std::pair<BitSet, BitSet>> genKill;
+		public:
+			AvailableExpressions(const FunctionPtr& fun) : WorklistAlgorithm(PD_Forward), fun(fun) {}
+
+			PtrList<AssignInsn> getExpressionsIn(const BasicBlockPtr& bb) const;
+			PtrList<AssignInsn> getExpressionsOut(const BasicBlockPtr& bb) const;
+		private:
+			void init() override;
+			BitSet top() const override;
+			BitSet boundary() const override;
+			void meet(BitSet& result, const BitSet& fact) const override;
+			BitSet transfer(const node_type& bb, const BitSet& fact) override;
+			node_list_type getSuccessors(const node_type& bb) const override;
+
+			PtrList<AssignInsn> toExpressionList(const FactMap<BasicBlock, BitSet>& map, const BasicBlockPtr& bb) const;
+	};
+}
+}
+}
@@ -2,7 +2,7 @@
 #include "core/analysis/analysis-callgraph.h"
 #include "core/analysis/analysis-insn.h"
 #include "core/analysis/analysis.h"
-#include "utils/utils-graph-dominator.h"
+#include "utils/utils-bitset.h"
 #include <algorithm>
 
 namespace core {
@@ -32,6 +32,25 @@ namespace controlflow {
 		return function->getGraph().getSuccessors(bb);
 	}
 
+	DominatorTree getDominatorTree(const FunctionPtr& function) {
+		return DominatorTree(function->getGraph());
+	}
+
+	DominatorTree getPostDominatorTree(const FunctionPtr& function) {
+		DirectedGraph<BasicBlock> reversed;
+		// the exit is the first vertex, thus it becomes the root
+		auto exit = std::make_shared<BasicBlock>();
+		exit->setLabel(std::make_shared<LabelInsn>(""));
+		reversed.addVertex(exit);
+		for (const auto& bb : function->getBasicBlocks()) {
+			reversed.addVertex(bb);
+			if (getSuccessors(function, bb).empty()) reversed.addEdge(exit, bb);
+		}
+		for (const auto& edge : function->getEdges())
+			reversed.addEdge(edge->getTarget(), edge->getSource());
+		return DominatorTree(reversed);
+	}
+
 	DominatorMap getDominatorMap(const FunctionPtr& function) {
 		return graph::dominator::getDominatorMap(function->getGraph());
 	}
@@ -40,44 +59,47 @@ namespace controlflow {
 		return graph::dominator::getImmediateDominator(map, bb);
 	}
 
-	DominatorMap getDominatorFrontierMap(const FunctionPtr& function, const DominatorMap& dominators) {
-		return graph::dominator::getDominatorFrontierMap(function->getGraph(), dominators);
+	DominatorMap getDominatorFrontierMap(const FunctionPtr& function, const DominatorTree& dominators) {
+		return graph::dominator::getDominatorFrontierMap(dominators, function->getGraph());
 	}
 
-	namespace {
-		void collectExtendedBasicBlocks(const FunctionPtr& function, const BasicBlockList& leaders,
-										const BasicBlockPtr& bb, BasicBlockList& result) {
-			// check for loops
-			auto it = std::find(result.begin(), result.end(), bb);
-			if (it != result.end()) return;
-			// check for end of ebb -- skip if result is empty as this is the base-case
-			if (result.size()) {
-				auto it = std::find(leaders.begin(), leaders.end(), bb);
-				if (it != leaders.end()) return;
+	std::vector<BasicBlockList> getExtendedBasicBlocks(const FunctionPtr& function) {
+		const auto& bbs = function->getBasicBlocks();
+		std::unordered_map<BasicBlockPtr, unsigned> index;
+		for (unsigned i = 0; i < bbs.size(); ++i)
+			index.insert(std::make_pair(bbs[i], i));
+		// query the successors once and count the predecessors of each bb
+		std::vector<std::vector<unsigned>> succs(bbs.size());
+		std::vector<unsigned> numOfPreds(bbs.size(), 0);
+		for (unsigned i = 0; i < bbs.size(); ++i) {
+			for (const auto& succ : controlflow::getSuccessors(function, bbs[i])) {
+				unsigned j = index.at(succ);
+				succs[i].push_back(j);
+				++numOfPreds[j];
 			}
-			// remember this one
-			result.push_back(bb);
-			// and collect all children -- recursion will stop if ebb is complete
-			for (const auto& succ : controlflow::getSuccessors(function, bb))
-				collectExtendedBasicBlocks(function, leaders, succ, result);
 		}
-	}
 
-	std::vector<BasicBlockList> getExtendedBasicBlocks(const FunctionPtr& function) {
+		// every bb which does not have exactly one pred leads an ebb, all others are
+		// part of the ebb of their pred, thus each ebb forms a tree which is
+		// collected in preorder using an explicit stack
 		std::vector<BasicBlockList> result;
-		// first step is to find all leaders of ebbs
-		auto leaders = controlflow::findBasicBlocks(function, [&](const BasicBlockPtr& bb) {
-			auto preds = controlflow::getPredecessors(function, bb);
-			// in case of root
-			if (preds.empty()) return true;
-			// in case we have multiple preds
-			if (preds.size() > 1) return true;
-			return false;
-		});
-		// second step is to expand each leader to the ebb set
-		for (const auto& leader : leaders) {
+		BitSet visited(bbs.size());
+		std::vector<unsigned> stack;
+		for (unsigned leader = 0; leader < bbs.size(); ++leader) {
+			if (numOfPreds[leader] == 1) continue;
 			result.push_back(BasicBlockList{});
-			collectExtendedBasicBlocks(function, leaders, leader, result.back());
+			stack.push_back(leader);
+			while (!stack.empty()) {
+				unsigned i = stack.back();
+				stack.pop_back();
+				if (visited.contains(i)) continue;
+				visited.insert(i);
+				result.back().push_back(bbs[i]);
+				// push in reverse order, thus successors are visited in their original one
+				for (auto it = succs[i].rbegin(); it != succs[i].rend(); ++it) {
+					if (numOfPreds[*it] == 1) stack.push_back(*it);
+				}
+			}
 		}
 		return result;
 	}
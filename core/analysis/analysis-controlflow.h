@@ -1,5 +1,6 @@
 #pragma once
 #include "core/core.h"
+#include "utils/utils-graph-dominator.h"
 #include <unordered_map>
 #include <type_traits>
 #include <set>
@@ -29,12 +30,19 @@ namespace controlflow {
 
 	typedef PtrSet<BasicBlock> DominatorSet;
 	typedef std::unordered_map<BasicBlockPtr, DominatorSet> DominatorMap;
+	typedef graph::dominator::DominatorTree<BasicBlock> DominatorTree;
+	DominatorTree getDominatorTree(const FunctionPtr& function);
+	// dominator tree of the reversed graph, its root is a virtual exit succeeding all bbs
+	// without a successor. the frontier of a bb yields the branches it is control dependent on
+	DominatorTree getPostDominatorTree(const FunctionPtr& function);
+
 	DominatorMap getDominatorMap(const FunctionPtr& function);
 
 	optional<BasicBlockPtr> getImmediateDominator(const DominatorMap& map, const BasicBlockPtr& bb);
 
-	DominatorMap getDominatorFrontierMap(const FunctionPtr& function, const DominatorMap& dominators);
+	DominatorMap getDominatorFrontierMap(const FunctionPtr& function, const DominatorTree& dominators);
 
+	// the bbs of each ebb are listed in preorder, starting with its leader
 	std::vector<BasicBlockList> getExtendedBasicBlocks(const FunctionPtr& function);
 
 	VariableSet getIncomingVars(const BasicBlockPtr& bb, bool visitTemporaries = false);
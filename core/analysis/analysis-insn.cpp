@@ -79,13 +79,11 @@ namespace insn {
 		InsnList result;
 
 		auto parent = insn->getParent();
-		const auto& insns = parent->getInsns();
-		// find our position with our parent
-		auto it = std::find(insns.begin(), insns.end(), insn);
-		assert(it != insns.end() && "insn does not belong to parent");
+		// each insn knows its position within the parent
+		auto it = BasicBlock::getPosition(insn);
 
 		// are we the last one?
-		if (*insns.rbegin() == insn) {
+		if (std::next(it) == parent->getInsns().end()) {
 			auto succs  = controlflow::getSuccessors(parent->getParent(), parent);
 			for (const auto& succ : succs) {
 				const auto& insns = succ->getInsns();
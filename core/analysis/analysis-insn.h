@@ -53,6 +53,12 @@ namespace insn {
 					preds::insertIf(rhs, pred, result);
 			}
 			break;
+		case Insn::IT_FalseJump:
+			{
+				auto fjmp = cast<FalseJumpInsn>(insn);
+				preds::insertIf(dyn_cast<Variable>(fjmp->getCond()), pred, result);
+			}
+			break;
 		case Insn::IT_Push:
 			{
 				auto push = cast<PushInsn>(insn);
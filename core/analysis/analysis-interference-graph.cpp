@@ -3,21 +3,48 @@
 #include "core/analysis/analysis-types.h"
 #include "core/analysis/analysis-live-variable.h"
 #include "core/analysis/analysis-controlflow.h"
+#include "core/analysis/analysis-loop.h"
 #include "core/analysis/analysis.h"
+#include <cmath>
 
 namespace core {
 namespace analysis {
 namespace interference {
+  namespace detail {
+    void collectLoopDepths(const loop::LoopList& loops, unsigned level, std::map<BasicBlockPtr, unsigned>& depth) {
+      for (const auto& loop : loops) {
+        // nested loops are visited afterwards, thus the innermost one wins
+        for (const auto& bb : loop->getBasicBlocks()) depth[bb] = level;
+        collectLoopDepths(loop->getChildren(), level + 1, depth);
+      }
+    }
+  }
+
+  bool isAllocatable(const VariablePtr& var, Type::TypeId type) {
+    // offsets hold addresses, thus they never reside in a sse register
+    if (type == Type::TI_Float && isOffset(var)) return false;
+    // names of static arrays at not allowed to be mapped!
+    return types::isType(var->getType(), type) ||
+          (types::isArray(var->getType()) && !var->getParent()->isConst() && type == Type::TI_Int);
+  }
+
+  VariablePtr getCopySource(const InsnPtr& insn, Type::TypeId type) {
+    if (!insn::isAssignInsn(insn)) return nullptr;
+    auto assign = cast<AssignInsn>(insn);
+    if (!assign->isAssign() || !isVariable(assign->getRhs1())) return nullptr;
+    const auto& lhs = assign->getLhs();
+    const auto& rhs = assign->getRhs1();
+    if (isOffset(lhs) || isOffset(rhs)) return nullptr;
+    if (!types::isType(lhs->getType(), type) || !types::isType(rhs->getType(), type)) return nullptr;
+    return cast<Variable>(rhs);
+  }
+
   InterferenceGraph getInterferenceGraph(const core::FunctionPtr& fun, Type::TypeId type,
-    const worklist::InsnLiveness& liveness, const InsnList& insns) {
+    const worklist::TwoLevelLiveness& liveness, const InsnList& insns) {
     using namespace core::analysis::worklist;
     InterferenceGraph result;
 
-    auto pred = [&](const VariablePtr& var) {
-      // names of static arrays at not allowed to be mapped!
-      return types::isType(var->getType(), type) ||
-            (types::isArray(var->getType()) && !var->getParent()->isConst() && type == Type::TI_Int);
-    };
+    auto pred = [&](const VariablePtr& var) { return isAllocatable(var, type); };
     // live ranges of parameters always interfere! sadly N^2 ..
     auto params = fun->getParameters();
     for (const auto& p1 : params) {
@@ -44,11 +71,15 @@ namespace interference {
       if (!types::isType(lhs->getType(), type)) continue;
       // add the vertex regardless of liveOut set
       result.addVertex(lhs);
+      // a copy leaves both variables with the same value, hence they do not
+      // interfere -- record it as move to be coalesced instead
+      auto source = getCopySource(insn, type);
+      if (source) result.addMove(lhs, source);
       // construct all required edges
       auto it = nodeData.find(insn);
       if (it != nodeData.end()) {
         for (const auto& var : it->second->getLiveOut()) {
-          if (*var == *lhs || !pred(var)) continue;
+          if (*var == *lhs || !pred(var) || (source && *var == *source)) continue;
           // check types as well as we do not build an edge to a different type
           if (!types::isType(var->getType(), type)) continue;
           result.addEdge(lhs, var);
@@ -58,6 +89,27 @@ namespace interference {
     return result;
   }
 
+  void setSpillCosts(InterferenceGraph& graph, const core::FunctionPtr& fun, const BasicBlockList& bbs) {
+    // only the loop nest is of interest, no nodes are built at all
+    NodeManager manager;
+    std::map<BasicBlockPtr, unsigned> depth;
+    detail::collectLoopDepths(loop::findLoops(manager, fun, bbs, false), 1, depth);
+
+    for (unsigned i = 0; i < graph.numberOfVertices(); ++i) graph.setWeight(i, 0.0);
+    for (const auto& bb : bbs) {
+      auto it = depth.find(bb);
+      double frequency = std::pow(10.0, it == depth.end() ? 0 : std::min(it->second, 8u));
+      for (const auto& insn : bb->getInsns()) {
+        for (const auto& vars : { insn::getInputVars(insn), insn::getOutputVars(insn) }) {
+          for (const auto& var : vars) {
+            int index = graph.getIndex(var);
+            if (index >= 0) graph.setWeight(index, graph.getWeight(index) + frequency);
+          }
+        }
+      }
+    }
+  }
+
   std::string InterferenceGraphPrinter::getVertexId(const vertex_type& vertex) const {
     std::string result = toString(*vertex);
     if (core::analysis::isTemporary(vertex)) result.replace(0, 1, "t");
@@ -6,9 +6,15 @@
 namespace core {
 namespace analysis {
 namespace interference {
-  typedef graph::color::ColorGraph<Variable> InterferenceGraph;
+  typedef graph::color::AllocationGraph<Variable> InterferenceGraph;
+  // whether the var may reside within a register of the given type
+  bool isAllocatable(const VariablePtr& var, Type::TypeId type);
+  // the var copied into the lhs of a plain copy insn, if any
+  VariablePtr getCopySource(const InsnPtr& insn, Type::TypeId type);
   InterferenceGraph getInterferenceGraph(const core::FunctionPtr& fun, Type::TypeId type,
-    const worklist::InsnLiveness& liveness, const InsnList& insns);
+    const worklist::TwoLevelLiveness& liveness, const InsnList& insns);
+  // weights each vertex by its defs and uses, scaled by 10^depth of the loop nest
+  void setSpillCosts(InterferenceGraph& graph, const core::FunctionPtr& fun, const BasicBlockList& bbs);
 
   class InterferenceGraphPrinter : public graph::color::ColorGraphPrinter<Variable> {
   public:
@@ -0,0 +1,56 @@
+#include "core/analysis/analysis-live-intervals.h"
+#include "core/analysis/analysis-interference-graph.h"
+#include "core/analysis/analysis-insn.h"
+#include <algorithm>
+
+namespace core {
+namespace analysis {
+namespace intervals {
+  LiveIntervals getLiveIntervals(const core::FunctionPtr& fun, Type::TypeId type,
+    const worklist::TwoLevelLiveness& liveness, const BasicBlockList& bbs) {
+    LiveIntervals result;
+    std::unordered_map<VariablePtr, unsigned, target_hash<Variable>, target_equal<Variable>> index;
+
+    auto extend = [&](const VariablePtr& var, unsigned pos) {
+      if (!interference::isAllocatable(var, type)) return;
+      auto it = index.find(var);
+      if (it == index.end()) {
+        index[var] = result.size();
+        result.push_back({var, pos, pos, nullptr});
+        return;
+      }
+      auto& interval = result[it->second];
+      interval.start = std::min(interval.start, pos);
+      interval.end = std::max(interval.end, pos);
+    };
+    // all parameters are loaded into their registers on entry
+    for (const auto& param : fun->getParameters()) extend(param, 0);
+
+    const auto& nodeData = liveness.getNodeData();
+    unsigned pos = 0;
+    for (const auto& bb : bbs) {
+      const auto& insns = bb->getInsns();
+      if (insns.empty()) continue;
+      // live in & out of the whole block cover all holes between defs and uses,
+      // which keeps the pass linear in contrast to the sets of each insn
+      for (const auto& var : nodeData.at(insns.front())->getLiveIn()) extend(var, pos);
+      for (const auto& insn : insns) {
+        for (const auto& var : insn::getInputVars(insn)) extend(var, pos);
+        for (const auto& var : insn::getOutputVars(insn)) extend(var, pos + 1);
+        // remember the first copy defining the var, allows to omit the move
+        if (auto source = interference::getCopySource(insn, type)) {
+          auto& interval = result[index[cast<AssignInsn>(insn)->getLhs()]];
+          if (!interval.hint) interval.hint = source;
+        }
+        pos += 2;
+      }
+      for (const auto& var : nodeData.at(insns.back())->getLiveOut()) extend(var, pos - 1);
+    }
+    // vars are visited in order of their positions, thus already sorted
+    assert(std::is_sorted(result.begin(), result.end(),
+      [](const LiveInterval& lhs, const LiveInterval& rhs) { return lhs.start < rhs.start; }));
+    return result;
+  }
+}
+}
+}
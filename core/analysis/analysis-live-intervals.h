@@ -0,0 +1,29 @@
+#pragma once
+#include "core/core.h"
+#include "core/analysis/analysis-live-variable.h"
+
+namespace core {
+namespace analysis {
+namespace intervals {
+  // the range of positions within the linear insn list in which a var is live,
+  // an insn i reads its inputs at 2i and writes its output at 2i + 1
+  struct LiveInterval {
+    VariablePtr var;
+    unsigned start;
+    unsigned end;
+    // var which is copied into this one, preferably shares the register
+    VariablePtr hint;
+
+    bool overlaps(const LiveInterval& other) const {
+      return start <= other.end && other.start <= end;
+    }
+  };
+  typedef std::vector<LiveInterval> LiveIntervals;
+
+  // computes the intervals of all allocatable vars of the given type ordered by
+  // start, positions are numbered along the given order of the basic blocks
+  LiveIntervals getLiveIntervals(const core::FunctionPtr& fun, Type::TypeId type,
+    const worklist::TwoLevelLiveness& liveness, const BasicBlockList& bbs);
+}
+}
+}
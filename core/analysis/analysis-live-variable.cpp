@@ -4,75 +4,186 @@
 namespace core {
 namespace analysis {
 namespace worklist {
-	void BasicBlockLiveness::init() {
-		VarSet<Variable> init;
-		for(auto bb : fun->getBasicBlocks())
-			in[bb] = init;
+namespace {
+	void convert(const VariableNumberingPtr& numbering, BitSet& pending, bool& converted, VariableSet& set) {
+		if (converted) return;
+		set = numbering->toVariableSet(pending);
+		pending = BitSet();
+		converted = true;
 	}
 
-	void BasicBlockLiveness::calcIn(const node_type& bb) {
-		auto use = controlflow::getIncomingVars(bb, true);
-		auto def = controlflow::getModifiedVars(bb, true);
-		in[bb] = algorithm::set_union(use, algorithm::set_difference(out[bb], def));
+	bool contains(const VariableNumberingPtr& numbering, const BitSet& pending, const VariablePtr& var) {
+		auto id = numbering->findId(var);
+		return id && pending.contains(*id);
 	}
+}
+	NodeData::NodeData(const VariableNumberingPtr& numbering, const BitSet& liveIn, const BitSet& liveOut) :
+		numbering(numbering), pendingIn(liveIn), pendingOut(liveOut), convertedIn(false), convertedOut(false)
+	{ }
 
-	void BasicBlockLiveness::calcOut(const node_type& bb) {
-		auto succs = controlflow::getSuccessors(fun, bb);
-		VarSet<Variable> result;
+	const VariableSet& NodeData::getLiveIn() const {
+		convert(numbering, pendingIn, convertedIn, liveIn);
+		return liveIn;
+	}
 
-		for(auto succ : succs)
-			result = algorithm::set_union(result, in[succ]);
+	VariableSet& NodeData::getLiveIn() {
+		convert(numbering, pendingIn, convertedIn, liveIn);
+		return liveIn;
+	}
 
-		out[bb] = result;
+	const VariableSet& NodeData::getLiveOut() const {
+		convert(numbering, pendingOut, convertedOut, liveOut);
+		return liveOut;
 	}
 
-	void BasicBlockLiveness::pushResult() {
-		const auto& bbs = fun->getBasicBlocks();
-		auto& nodeData = getNodeData();
+	VariableSet& NodeData::getLiveOut() {
+		convert(numbering, pendingOut, convertedOut, liveOut);
+		return liveOut;
+	}
+
+	void NodeData::setLiveIn(const VariableSet& set) {
+		liveIn = set;
+		pendingIn = BitSet();
+		convertedIn = true;
+	}
+
+	void NodeData::setLiveOut(const VariableSet& set) {
+		liveOut = set;
+		pendingOut = BitSet();
+		convertedOut = true;
+	}
 
-		for(const auto& bb : bbs) {
-			if(nodeData.find(bb) == nodeData.end()) {
-				auto data = buildNodeData();
-				nodeData.insert(std::make_pair(bb, data));
+	bool NodeData::isLiveIn(const VariablePtr& var) const {
+		return convertedIn ? liveIn.count(var) : contains(numbering, pendingIn, var);
+	}
+
+	bool NodeData::isLiveOut(const VariablePtr& var) const {
+		return convertedOut ? liveOut.count(var) : contains(numbering, pendingOut, var);
+	}
+
+	std::ostream& NodeData::printTo(std::ostream& stream) const {
+		stream << "LIVEIN: {";
+		bool first = true;
+		for(auto in : getLiveIn()){
+			if(first) {
+				in->printTo(stream);
+				first = false;
+			} else {
+				stream << ", ";
+				in->printTo(stream);
+			}
+		}
+
+		stream << "}" << std::endl << "LIVEOUT: {";
+		first = true;
+
+		for(auto out : getLiveOut()){
+			if(first) {
+				out->printTo(stream);
+				first = false;
+			} else {
+				stream << ", ";
+				out->printTo(stream);
 			}
-			nodeData[bb]->setLiveIn(in[bb]);
-			nodeData[bb]->setLiveOut(out[bb]);
 		}
+		stream << "}";
+		return stream;
+	}
+
+	template<typename TNode>
+	BitSet Liveness<TNode>::top() const {
+		return BitSet(numbering.size());
+	}
+
+	template<typename TNode>
+	void Liveness<TNode>::meet(BitSet& result, const BitSet& fact) const {
+		result |= fact;
+	}
+
+	template<typename TNode>
+	BitSet Liveness<TNode>::transfer(const node_type& node, const BitSet& fact) {
+		auto it = useDef.find(node);
+		if (it == useDef.end()) {
+			auto use = numbering.toBitSet(getUseVars(node));
+			auto def = numbering.toBitSet(getDefVars(node));
+			it = useDef.insert(std::make_pair(node, std::make_pair(use, def))).first;
+		}
+		// in = use + (out - def)
+		BitSet result = fact;
+		result -= it->second.second;
+		result |= it->second.first;
+		return result;
+	}
+
+	template<typename TNode>
+	void Liveness<TNode>::pushResult() {
+		// shared by the results, which convert their bitsets lazily
+		auto shared = std::make_shared<const numbering::VariableNumbering>(numbering);
+		for (const auto& pair : this->in) {
+			auto key = pair.first;
+			nodeData[key] = std::make_shared<NodeData>(shared, pair.second, this->out[key]);
+		}
+	}
+
+	template class Liveness<BasicBlock>;
+	template class Liveness<Insn>;
+
+	void BasicBlockLiveness::init() {
+		numbering = numbering::VariableNumbering(fun);
 	}
 
-	void InsnLiveness::init() {
-		// no-op
+	VariableSet BasicBlockLiveness::getUseVars(const node_type& bb) const {
+		return controlflow::getIncomingVars(bb, true);
 	}
 
-	void InsnLiveness::calcIn(const node_type& bb) {
-		auto use = insn::getInputVars(bb);
-		auto def = insn::getOutputVars(bb);
+	VariableSet BasicBlockLiveness::getDefVars(const node_type& bb) const {
+		return controlflow::getModifiedVars(bb, true);
+	}
 
-		in[bb] = algorithm::set_union(use, algorithm::set_difference(out[bb], def));
+	BasicBlockLiveness::node_list_type BasicBlockLiveness::getSuccessors(const node_type& bb) const {
+		return controlflow::getSuccessors(fun, bb);
 	}
 
-	void InsnLiveness::calcOut(const node_type& bb) {
-		auto succs = insn::getSuccessors(bb);
-		VarSet<Variable> result;
+	VariableSet InsnLiveness::getUseVars(const node_type& insn) const {
+		return insn::getInputVars(insn);
+	}
 
-		for(auto succ : succs)
-			result = algorithm::set_union(result, in[succ]);
+	VariableSet InsnLiveness::getDefVars(const node_type& insn) const {
+		return insn::getOutputVars(insn);
+	}
 
-		out[bb] = result;
+	InsnLiveness::node_list_type InsnLiveness::getSuccessors(const node_type& insn) const {
+		return insn::getSuccessors(insn);
 	}
 
-	void InsnLiveness::pushResult() {
-		auto& nodeData = getNodeData();
-		for (const auto& pair : in) {
-			auto key = pair.first;
-			if(nodeData.find(key) == nodeData.end()) {
-				auto data = buildNodeData();
-				nodeData.insert(std::make_pair(key, data));
+	void TwoLevelLiveness::apply(const FunctionPtr& fun) {
+		const auto& bbs = fun->getBasicBlocks();
+		BasicBlockLiveness blocks(fun);
+		blocks.apply(bbs.begin(), bbs.end());
+
+		// all variables of the function have been numbered by the block level
+		auto numbering = std::make_shared<numbering::VariableNumbering>(blocks.getNumbering());
+		const auto& out = blocks.getOut();
+		nodeData.clear();
+		for (const auto& bb : bbs) {
+			BitSet live = out.at(bb);
+			const auto& insns = bb->getInsns();
+			for (auto it = insns.rbegin(); it != insns.rend(); ++it) {
+				BitSet liveOut = live;
+				// in = use + (out - def)
+				live -= numbering->toBitSet(insn::getOutputVars(*it));
+				live |= numbering->toBitSet(insn::getInputVars(*it));
+				nodeData.insert(std::make_pair(*it, std::make_shared<NodeData>(numbering, live, liveOut)));
 			}
-			nodeData[key]->setLiveIn(pair.second);
-			nodeData[key]->setLiveOut(out[key]);
 		}
 	}
 }
 }
+namespace utils {
+	std::string toString(const analysis::worklist::NodeData& nd) {
+    std::stringstream ss;
+		nd.printTo(ss);
+		return ss.str();
+  }
+}
 }
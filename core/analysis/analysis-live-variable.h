@@ -1,32 +1,105 @@
 #pragma once
 #include "core/core.h"
 #include "core/analysis/analysis-worklist.h"
+#include "core/analysis/analysis-numbering.h"
 
 namespace core {
 namespace analysis {
 namespace worklist {
-	class BasicBlockLiveness : public WorklistAlgorithm<Variable, BasicBlock> {
-		FunctionPtr fun;
+	typedef std::shared_ptr<const numbering::VariableNumbering> VariableNumberingPtr;
+
+	// the sets computed by the analyses are kept as bitsets over the numbering
+	// of the function, each one is turned into a VariableSet once it is needed
+	class NodeData  : public Printable {
+		mutable VariableSet liveIn;
+		mutable VariableSet liveOut;
+		VariableNumberingPtr numbering;
+		mutable BitSet pendingIn;
+		mutable BitSet pendingOut;
+		mutable bool convertedIn;
+		mutable bool convertedOut;
+
 		public:
-			BasicBlockLiveness(const FunctionPtr& fun) : WorklistAlgorithm (PD_Backward), fun(fun) {}
-		private:
-			typedef WorklistAlgorithm<Variable, BasicBlock>::node_type node_type;
-			void init() override;
-			void calcIn(const node_type& bb) override;
-			void calcOut(const node_type& bb) override;
+			NodeData() : convertedIn(true), convertedOut(true) {}
+			NodeData(const VariableNumberingPtr& numbering, const BitSet& liveIn, const BitSet& liveOut);
+
+			const VariableSet& getLiveIn() const;
+			VariableSet& getLiveIn();
+			const VariableSet& getLiveOut() const;
+			VariableSet& getLiveOut();
+			void setLiveIn(const VariableSet& set);
+			void setLiveOut(const VariableSet& set);
+			// membership tests which do not require the sets to be converted
+			bool isLiveIn(const VariablePtr& var) const;
+			bool isLiveOut(const VariablePtr& var) const;
+
+			std::ostream& printTo(std::ostream& stream) const override;
+	};
+	class NodeData;
+	typedef Ptr<NodeData> NodeDataPtr;
+	template<typename T>
+	using NodeDataMap = std::unordered_map<Ptr<T>, NodeDataPtr>;
+
+	// backward may-problem on bitsets over the dense variable ids of the
+	// function, results are converted back to VariableSet on demand
+	template<typename TNode>
+	class Liveness : public WorklistAlgorithm<TNode, BitSet> {
+		public:
+			typedef typename WorklistAlgorithm<TNode, BitSet>::node_type node_type;
+
+			NodeDataMap<TNode>& getNodeData() { return nodeData; }
+			const NodeDataMap<TNode>& getNodeData() const { return nodeData; }
+			const numbering::VariableNumbering& getNumbering() const { return numbering; }
+		protected:
+			Liveness() : WorklistAlgorithm<TNode, BitSet>(PD_Backward) {}
+
+			virtual VariableSet getUseVars(const node_type& node) const = 0;
+			virtual VariableSet getDefVars(const node_type& node) const = 0;
+
+			BitSet top() const override;
+			void meet(BitSet& result, const BitSet& fact) const override;
+			BitSet transfer(const node_type& node, const BitSet& fact) override;
 			void pushResult() override;
+
+			numbering::VariableNumbering numbering;
+		private:
+			NodeDataMap<TNode> nodeData;
+			// use & def sets do not change during the iteration, compute them once
+			FactMap<TNode, std::pair<BitSet, BitSet>> useDef;
 	};
 
-	class InsnLiveness : public WorklistAlgorithm<Variable, Insn> {
+	class BasicBlockLiveness : public Liveness<BasicBlock> {
+		FunctionPtr fun;
 		public:
-			InsnLiveness() : WorklistAlgorithm (PD_Backward) {}
+			BasicBlockLiveness(const FunctionPtr& fun) : fun(fun) {}
 		private:
-			typedef WorklistAlgorithm<Variable, Insn>::node_type node_type;
 			void init() override;
-			void calcIn(const node_type& bb) override;
-			void calcOut(const node_type& bb) override;
-			void pushResult() override;
+			VariableSet getUseVars(const node_type& bb) const override;
+			VariableSet getDefVars(const node_type& bb) const override;
+			node_list_type getSuccessors(const node_type& bb) const override;
+	};
+
+	class InsnLiveness : public Liveness<Insn> {
+		private:
+			VariableSet getUseVars(const node_type& insn) const override;
+			VariableSet getDefVars(const node_type& insn) const override;
+			node_list_type getSuccessors(const node_type& insn) const override;
+	};
+
+	// per insn liveness of a whole function computed in two steps: a fixpoint
+	// on basic block level followed by a single backward sweep through each
+	// block which derives the sets of its insns from the liveOut of the block
+	class TwoLevelLiveness {
+		NodeDataMap<Insn> nodeData;
+		public:
+			void apply(const FunctionPtr& fun);
+
+			NodeDataMap<Insn>& getNodeData() { return nodeData; }
+			const NodeDataMap<Insn>& getNodeData() const { return nodeData; }
 	};
 }
 }
+namespace utils {
+	std::string toString(const analysis::worklist::NodeData& nd);
+}
 }
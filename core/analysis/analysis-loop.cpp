@@ -43,7 +43,7 @@ namespace loop {
       indices.push_back(res);
     }
 
-    arithmetic::formula::TermPtr extractTerm(InsnList::const_reverse_iterator it, const InsnList& insns, const VariablePtr& tmp) {
+    arithmetic::formula::TermPtr extractTerm(InsnChain::const_reverse_iterator it, const InsnChain& insns, const VariablePtr& tmp) {
       arithmetic::formula::TermPtr result;
       // try to find the assignment where tmp is defined
       for (; it != insns.rend(); ++it) {
@@ -82,8 +82,8 @@ namespace loop {
       return result;
     }
 
-    SubscriptPtr extractSubscript(NodeManager& manager, const LoopPtr& loop, InsnList::const_reverse_iterator it,
-      const InsnList& insns, const VariablePtr& off) {
+    SubscriptPtr extractSubscript(NodeManager& manager, const LoopPtr& loop, InsnChain::const_reverse_iterator it,
+      const InsnChain& insns, const VariablePtr& off) {
       auto begin = it;
       VariablePtr var;
       IndexList indices;
@@ -267,7 +267,7 @@ namespace loop {
     return findLoops(manager, fun, controlflow::getLinearBasicBlockList(fun));
   }
 
-  LoopList findLoops(NodeManager& manager, const FunctionPtr& fun, const BasicBlockList& bbs) {
+  LoopList findLoops(NodeManager& manager, const FunctionPtr& fun, const BasicBlockList& bbs, bool statements) {
     LoopList result;
     LoopList loops;
     std::stack<LoopPtr> nest;
@@ -322,7 +322,9 @@ namespace loop {
     }
     // find all statements, prior to this point it is not valid due to
     // overlapping regions of parent / child
-    for (const auto& loop : loops) detail::collectStatements(manager, loop);
+    if (statements) {
+      for (const auto& loop : loops) detail::collectStatements(manager, loop);
+    }
     return result;
   }
 
@@ -85,7 +85,8 @@ namespace loop {
   };
 
   LoopList findLoops(NodeManager& manager, const FunctionPtr& fun);
-  LoopList findLoops(NodeManager& manager, const FunctionPtr& fun, const BasicBlockList& bbs);
+  // statements = false only recovers the loop nest, e.g. to estimate frequencies
+  LoopList findLoops(NodeManager& manager, const FunctionPtr& fun, const BasicBlockList& bbs, bool statements = true);
 
   bool hasNoDependency(NodeManager& manager, const SubscriptPtr& write, const SubscriptPtr& other);
 }
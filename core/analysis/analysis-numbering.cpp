@@ -0,0 +1,49 @@
+#include "core/analysis/analysis-numbering.h"
+#include "core/analysis/analysis-controlflow.h"
+
+namespace core {
+namespace analysis {
+namespace numbering {
+	VariableNumbering::VariableNumbering(const FunctionPtr& fun) {
+		for (const auto& var : fun->getParameters())
+			getId(var);
+		for (const auto& var : controlflow::getAllVars(fun, true))
+			getId(var);
+	}
+
+	unsigned VariableNumbering::getId(const VariablePtr& var) {
+		auto it = ids.find(var);
+		if (it != ids.end()) return it->second;
+
+		unsigned id = variables.size();
+		ids.insert(std::make_pair(var, id));
+		variables.push_back(var);
+		return id;
+	}
+
+	optional<unsigned> VariableNumbering::findId(const VariablePtr& var) const {
+		auto it = ids.find(var);
+		if (it == ids.end()) return {};
+		return it->second;
+	}
+
+	const VariablePtr& VariableNumbering::getVariable(unsigned id) const {
+		assert(id < variables.size() && "variable id out of range");
+		return variables[id];
+	}
+
+	BitSet VariableNumbering::toBitSet(const VariableSet& set) {
+		BitSet result(variables.size());
+		for (const auto& var : set)
+			result.insert(getId(var));
+		return result;
+	}
+
+	VariableSet VariableNumbering::toVariableSet(const BitSet& set) const {
+		VariableSet result;
+		set.forEach([&](size_t id) { result.insert(getVariable(id)); });
+		return result;
+	}
+}
+}
+}
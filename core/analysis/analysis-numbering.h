@@ -0,0 +1,30 @@
+#pragma once
+#include "core/core.h"
+#include "utils/utils-bitset.h"
+
+namespace core {
+namespace analysis {
+namespace numbering {
+	// assigns dense ids (0, 1, ..) to the variables of a function such that sets
+	// of variables can be represented by bitsets during dataflow analysis
+	class VariableNumbering {
+	public:
+		VariableNumbering() {}
+		// number all variables & temporaries of the given function up front
+		VariableNumbering(const FunctionPtr& fun);
+
+		// returns the id of the given variable, unknown ones get a fresh id
+		unsigned getId(const VariablePtr& var);
+		optional<unsigned> findId(const VariablePtr& var) const;
+		const VariablePtr& getVariable(unsigned id) const;
+		size_t size() const { return variables.size(); }
+
+		BitSet toBitSet(const VariableSet& set);
+		VariableSet toVariableSet(const BitSet& set) const;
+	private:
+		std::unordered_map<VariablePtr, unsigned, target_hash<Variable>, target_equal<Variable>> ids;
+		VariableList variables;
+	};
+}
+}
+}
@@ -0,0 +1,83 @@
+#include "core/analysis/analysis-reaching-definitions.h"
+#include "core/analysis/analysis-insn.h"
+
+namespace core {
+namespace analysis {
+namespace worklist {
+	void ReachingDefinitions::init() {
+		numbering = numbering::VariableNumbering(fun);
+		definitions.clear();
+		ids.clear();
+		genKill.clear();
+
+		// number all definitions and group them by the variable they define
+		std::vector<BitSet> defsOfVar(numbering.size());
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (const auto& insn : bb->getInsns()) {
+				for (const auto& var : insn::getOutputVars(insn)) {
+					unsigned id = definitions.size();
+					definitions.push_back(insn);
+					ids.insert(std::make_pair(insn, id));
+
+					unsigned varId = numbering.getId(var);
+					if (varId >= defsOfVar.size()) defsOfVar.resize(varId + 1);
+					defsOfVar[varId].insert(id);
+				}
+			}
+		}
+
+		for (const auto& bb : fun->getBasicBlocks()) {
+			BitSet gen(definitions.size());
+			BitSet kill(definitions.size());
+			for (const auto& insn : bb->getInsns()) {
+				for (const auto& var : insn::getOutputVars(insn)) {
+					const auto& others = defsOfVar[numbering.getId(var)];
+					// a later definition within the block overrides the previous ones
+					gen -= others;
+					kill |= others;
+					gen.insert(ids.at(insn));
+				}
+			}
+			genKill[bb] = std::make_pair(gen, kill);
+		}
+	}
+
+	BitSet ReachingDefinitions::top() const {
+		return BitSet(definitions.size());
+	}
+
+	void ReachingDefinitions::meet(BitSet& result, const BitSet& fact) const {
+		result |= fact;
+	}
+
+	BitSet ReachingDefinitions::transfer(const node_type& bb, const BitSet& fact) {
+		const auto& sets = genKill.at(bb);
+		// out = gen + (in - kill)
+		BitSet result = fact;
+		result -= sets.second;
+		result |= sets.first;
+		return result;
+	}
+
+	ReachingDefinitions::node_list_type ReachingDefinitions::getSuccessors(const node_type& bb) const {
+		return controlflow::getSuccessors(fun, bb);
+	}
+
+	InsnList ReachingDefinitions::toInsnList(const FactMap<BasicBlock, BitSet>& map, const BasicBlockPtr& bb) const {
+		InsnList result;
+		auto it = map.find(bb);
+		if (it == map.end()) return result;
+		it->second.forEach([&](size_t id) { result.push_back(definitions[id]); });
+		return result;
+	}
+
+	InsnList ReachingDefinitions::getDefinitionsIn(const BasicBlockPtr& bb) const {
+		return toInsnList(in, bb);
+	}
+
+	InsnList ReachingDefinitions::getDefinitionsOut(const BasicBlockPtr& bb) const {
+		return toInsnList(out, bb);
+	}
+}
+}
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "core/core.h"
+#include "core/analysis/analysis-worklist.h"
+#include "core/analysis/analysis-numbering.h"
+
+namespace core {
+namespace analysis {
+namespace worklist {
+	// forward may-problem: which definitions (insns with an output variable)
+	// may reach the entry resp. exit of each basic block
+	class ReachingDefinitions : public WorklistAlgorithm<BasicBlock, BitSet> {
+		FunctionPtr fun;
+		numbering::VariableNumbering numbering;
+		// all definitions of the function and their dense ids
+		InsnList definitions;
+		std::unordered_map<InsnPtr, unsigned> ids;
+		FactMap<BasicBlock, std::pair<BitSet, BitSet>> genKill;
+		public:
+			ReachingDefinitions(const FunctionPtr& fun) : WorklistAlgorithm(PD_Forward), fun(fun) {}
+
+			InsnList getDefinitionsIn(const BasicBlockPtr& bb) const;
+			InsnList getDefinitionsOut(const BasicBlockPtr& bb) const;
+		private:
+			void init() override;
+			BitSet top() const override;
+			void meet(BitSet& result, const BitSet& fact) const override;
+			BitSet transfer(const node_type& bb, const BitSet& fact) override;
+			node_list_type getSuccessors(const node_type& bb) const override;
+
+			InsnList toInsnList(const FactMap<BasicBlock, BitSet>& map, const BasicBlockPtr& bb) const;
+	};
+}
+}
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <set>
+#include <deque>
 #include "core/core.h"
 #include "core/analysis/analysis-controlflow.h"
 
@@ -7,91 +8,141 @@ namespace core {
 namespace analysis {
 namespace worklist {
 
-	template <typename T>
-	using VarSet = PtrSet<T>;
-	template <typename T, typename U>
-	using Map = std::unordered_map<Ptr<T>, VarSet<U>>;
-
-	class NodeData  : public Printable {
-		VariableSet liveIn;
-		VariableSet liveOut;
-
-		public:
-			const VariableSet& getLiveIn() const;
-			VariableSet& getLiveIn();
-			const VariableSet& getLiveOut() const;
-			VariableSet& getLiveOut();
-			void setLiveIn(const VariableSet& set);
-			void setLiveOut(const VariableSet& set);
-
-			std::ostream& printTo(std::ostream& stream) const override;
-	};
-	class NodeData;
-	typedef Ptr<NodeData> NodeDataPtr;
-	template<typename T>
-	using NodeDataMap = std::unordered_map<Ptr<T>, NodeDataPtr>;
+	template <typename T, typename TFact>
+	using FactMap = std::unordered_map<Ptr<T>, TFact>;
 
 	enum ProblemDirection {
 		PD_Forward,
 		PD_Backward
 	};
 
-	template<typename T, typename U>
+	// generic dataflow solver over the lattice of TFact, a fact has to be
+	// copyable and comparable by operator !=
+	//
+	// derived analyses describe the lattice by top() (identity of meet and the
+	// initial value of each node), boundary() (the value flowing into the
+	// entry resp. out of the exit nodes), meet() and the transfer function
+	// of a single node. the successors of each node are queried exactly once,
+	// the worklist is seeded in reverse postorder for forward problems and
+	// in postorder for backward ones and only the neighbours of nodes whose
+	// result changed are revisited.
+	template<typename TNode, typename TFact>
 	class WorklistAlgorithm {
+		public:
+			typedef Ptr<TNode> node_type;
+			typedef PtrList<TNode> node_list_type;
+			typedef TFact fact_type;
+
+			template<typename ForwardIt>
+			void apply(ForwardIt begin, ForwardIt end);
+
+			// facts at the entry resp. exit of a node, regardless of the direction
+			const FactMap<TNode, TFact>& getIn() const { return in; }
+			const FactMap<TNode, TFact>& getOut() const { return out; }
 		protected:
 			WorklistAlgorithm(ProblemDirection dir) : dir(dir) { }
+			virtual ~WorklistAlgorithm() { }
+
+			virtual void init() { }
+			virtual TFact top() const = 0;
+			virtual TFact boundary() const { return top(); }
+			virtual void meet(TFact& result, const TFact& fact) const = 0;
+			virtual TFact transfer(const node_type& node, const TFact& fact) = 0;
+			virtual node_list_type getSuccessors(const node_type& node) const = 0;
+			virtual void pushResult() { }
+
+			ProblemDirection dir;
+			FactMap<TNode, TFact> in;
+			FactMap<TNode, TFact> out;
+	};
+
+	template<typename TNode, typename TFact>
+	template<typename ForwardIt>
+	void WorklistAlgorithm<TNode, TFact>::apply(ForwardIt begin, ForwardIt end) {
+		init();
 
-			NodeDataPtr buildNodeData() {
-				return std::make_shared<NodeData>();
+		// enumerate the given nodes, edges leaving this range are ignored
+		node_list_type nodes;
+		std::unordered_map<node_type, unsigned> index;
+		for (auto it = begin; it != end; ++it) {
+			if (index.insert(std::make_pair(*it, nodes.size())).second)
+				nodes.push_back(*it);
+		}
+
+		std::vector<std::vector<unsigned>> succs(nodes.size());
+		std::vector<std::vector<unsigned>> preds(nodes.size());
+		for (unsigned i = 0; i < nodes.size(); ++i) {
+			for (const auto& succ : getSuccessors(nodes[i])) {
+				auto it = index.find(succ);
+				if (it == index.end()) continue;
+				succs[i].push_back(it->second);
+				preds[it->second].push_back(i);
 			}
+		}
 
-			typedef Ptr<U> node_type;
+		// iterative dfs starting at the first node, unreachable ones are appended
+		std::vector<unsigned> order;
+		std::vector<bool> visited(nodes.size());
+		std::vector<std::pair<unsigned, unsigned>> stack;
+		for (unsigned root = 0; root < nodes.size(); ++root) {
+			if (visited[root]) continue;
+			visited[root] = true;
+			stack.push_back(std::make_pair(root, 0));
+			while (!stack.empty()) {
+				auto& frame = stack.back();
+				if (frame.second < succs[frame.first].size()) {
+					unsigned succ = succs[frame.first][frame.second++];
+					if (!visited[succ]) {
+						visited[succ] = true;
+						stack.push_back(std::make_pair(succ, 0));
+					}
+				} else {
+					order.push_back(frame.first);
+					stack.pop_back();
+				}
+			}
+		}
 
-			virtual void init() = 0;
-			virtual void calcIn(const node_type& bb) = 0;
-			virtual void calcOut(const node_type& bb) = 0;
-			virtual void pushResult() = 0;
-			ProblemDirection dir;
-			Map<U, T> in;
-			Map<U, T> out;
+		bool forward = (dir == PD_Forward);
+		if (forward) std::reverse(order.begin(), order.end());
 
-		public:
-			NodeDataMap<U>& getNodeData() { return nodeData; }
-			const NodeDataMap<U>& getNodeData() const { return nodeData; }
-			NodeDataMap<U> nodeData;
+		// incoming edges w.r.t. the direction of the problem and vice versa
+		const auto& sources = forward ? preds : succs;
+		const auto& targets = forward ? succs : preds;
 
-			template<typename ForwardIt>
-			void apply(ForwardIt begin, ForwardIt end) {
-				bool change = true;
-				bool forward = (dir == PD_Forward);
-
-				init();
-
-				VarSet<T> oldIn;
-				VarSet<T> oldOut;
-
-				while(change) {
-					change = false;
-					std::for_each(begin, end, [&](const auto& bb) {
-						if(forward) {
-							oldOut = out[bb];
-							this->calcIn(bb);
-							this->calcOut(bb);
-							change |= (oldOut != out[bb]);
-						} else {
-							oldIn = in[bb];
-							this->calcOut(bb);
-							this->calcIn(bb);
-							change |= (oldIn != in[bb]);
-						}
-					});
+		std::vector<TFact> input(nodes.size(), top());
+		std::vector<TFact> output(nodes.size(), top());
+
+		std::deque<unsigned> queue(order.begin(), order.end());
+		std::vector<bool> queued(nodes.size(), true);
+		while (!queue.empty()) {
+			unsigned cur = queue.front();
+			queue.pop_front();
+			queued[cur] = false;
+
+			bool isBoundary = sources[cur].empty() || (forward && cur == 0);
+			TFact fact = isBoundary ? boundary() : top();
+			for (unsigned src : sources[cur])
+				meet(fact, output[src]);
+			input[cur] = fact;
+
+			fact = transfer(nodes[cur], input[cur]);
+			if (fact != output[cur]) {
+				output[cur] = fact;
+				for (unsigned dst : targets[cur]) {
+					if (queued[dst]) continue;
+					queued[dst] = true;
+					queue.push_back(dst);
 				}
-				pushResult();
 			}
-	};
-}
+		}
+
+		for (unsigned i = 0; i < nodes.size(); ++i) {
+			in[nodes[i]] = forward ? input[i] : output[i];
+			out[nodes[i]] = forward ? output[i] : input[i];
+		}
+		pushResult();
+	}
 }
-namespace utils {
-	std::string toString(const analysis::worklist::NodeData& nd);
 }
 }
@@ -14,38 +14,55 @@ namespace arithmetic {
 			   (*lhs->getType() == *rhs->getType());
 	}
 
-	ValuePtr evaluate(NodeManager& manager, AssignInsn::OpType op, const ValuePtr& lhs, const ValuePtr& rhs) {
-		assert(isEvaluable(lhs, rhs) && "expression is not evaluable");
-		assert((op != AssignInsn::NONE &&	op != AssignInsn::NOT) && "unary op supplied");
-		float result = 0.0;
-		switch (op) {
-		case AssignInsn::LT:	result = getValue<float>(lhs) < getValue<float>(rhs); break;
-		case AssignInsn::GT:	result = getValue<float>(lhs) > getValue<float>(rhs); break;
-		case AssignInsn::ADD:	result = getValue<float>(lhs) + getValue<float>(rhs); break;
-		case AssignInsn::SUB:	result = getValue<float>(lhs) - getValue<float>(rhs); break;
-		case AssignInsn::MUL:	result = getValue<float>(lhs) * getValue<float>(rhs); break;
-		case AssignInsn::EQ:	result = getValue<float>(lhs) == getValue<float>(rhs); break;
-		case AssignInsn::NE:	result = getValue<float>(lhs) != getValue<float>(rhs); break;
-		case AssignInsn::LE:	result = getValue<float>(lhs) <= getValue<float>(rhs); break;
-		case AssignInsn::GE:	result = getValue<float>(lhs) >= getValue<float>(rhs); break;
-		case AssignInsn::DIV:
-			{
-				auto div = getValue<float>(rhs);
-				if (div == 0)
+	namespace detail {
+		template<typename T>
+		T compute(AssignInsn::OpType op, T lhs, T rhs) {
+			switch (op) {
+			case AssignInsn::LT:	return lhs < rhs;
+			case AssignInsn::GT:	return lhs > rhs;
+			case AssignInsn::ADD:	return lhs + rhs;
+			case AssignInsn::SUB:	return lhs - rhs;
+			case AssignInsn::MUL:	return lhs * rhs;
+			case AssignInsn::EQ:	return lhs == rhs;
+			case AssignInsn::NE:	return lhs != rhs;
+			case AssignInsn::LE:	return lhs <= rhs;
+			case AssignInsn::GE:	return lhs >= rhs;
+			case AssignInsn::DIV:
 					// undefined value!
-					break;
-
-				result = getValue<float>(lhs) / div;
-				break;
+					if (rhs == 0) return 0;
+					return lhs / rhs;
+			default:
+					assert(false && "unsupported op for evaluation");
+					return 0;
 			}
-		default:
-				assert(false && "unsupported op for evaluation");
 		}
+	}
 
+	ValuePtr evaluate(NodeManager& manager, AssignInsn::OpType op, const ValuePtr& lhs, const ValuePtr& rhs) {
+		assert(isEvaluable(lhs, rhs) && "expression is not evaluable");
+		assert((op != AssignInsn::NONE &&	op != AssignInsn::NOT) && "unary op supplied");
+		// ints are computed as such, a float does not hold all of their digits. the
+		// wider type keeps an overflow defined, it wraps around as on the target
 		if (analysis::types::isInt(lhs->getType()))
+			return manager.buildIntConstant(static_cast<int>(detail::compute<long long>(op,
+				getValue<int>(lhs), getValue<int>(rhs))));
+
+		auto result = detail::compute<float>(op, getValue<float>(lhs), getValue<float>(rhs));
+		// a comparison yields an int regardless of its operands
+		if (AssignInsn::isLogicalBinaryOp(op))
 			return manager.buildIntConstant(result);
-		else
-			return manager.buildFloatConstant(result);
+		return manager.buildFloatConstant(result);
+	}
+
+	ValuePtr evaluate(NodeManager& manager, AssignInsn::OpType op, const ValuePtr& rhs) {
+		assert(analysis::isConstant(rhs) && "expression is not evaluable");
+		assert(AssignInsn::isUnaryOp(op) && "binary op supplied");
+		if (analysis::types::isInt(rhs->getType())) {
+			int value = getValue<int>(rhs);
+			return manager.buildIntConstant(op == AssignInsn::SUB ? -static_cast<long long>(value) : !value);
+		}
+		float value = getValue<float>(rhs);
+		return manager.buildFloatConstant(op == AssignInsn::SUB ? -value : !value);
 	}
 
 	namespace detail {
@@ -17,6 +17,7 @@ namespace arithmetic {
 
 	bool isEvaluable(const ValuePtr& lhs, const ValuePtr& rhs);
 	ValuePtr evaluate(NodeManager& manager, AssignInsn::OpType op, const ValuePtr& lhs, const ValuePtr& rhs);
+	ValuePtr evaluate(NodeManager& manager, AssignInsn::OpType op, const ValuePtr& rhs);
 
 	optional<ValuePtr> tryGcd(NodeManager& manager, const ValueList& values);
 
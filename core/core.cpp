@@ -4,8 +4,10 @@
 #include "core/analysis/analysis-types.h"
 #include "core/analysis/analysis-callgraph.h"
 #include "core/analysis/analysis-controlflow.h"
+#include "core/analysis/analysis-insn.h"
 #include <algorithm>
 #include <fstream>
+#include <cstring>
 
 namespace core {
 	namespace detail {
@@ -49,9 +51,10 @@ namespace core {
 	}
 
 	TypePtr NodeManager::buildBasicType(Type::TypeId typeId) {
-		assert(typeId != Type::TI_Function && "invalid typeid passed");
-		auto ptr = std::make_shared<Type>(typeId);
-		return types.add(ptr);
+		assert(typeId != Type::TI_Function && typeId != Type::TI_Array && "invalid typeid passed");
+		auto& type = basicTypes[typeId];
+		if (!type) type = types.add(std::make_shared<Type>(typeId));
+		return type;
 	}
 
 	ArrayTypePtr NodeManager::buildArrayType(const TypePtr& elementType, const unsigned numOfDims) {
@@ -98,6 +101,11 @@ namespace core {
 		return values.add(ptr);
 	}
 
+	VariablePtr NodeManager::buildVariable(const VariablePtr& var, unsigned ssaIndex) {
+		auto ptr = std::make_shared<Variable>(var->getValueCategory(), var->getValueType(), var->getType(), var->getBaseName(), ssaIndex);
+		return values.add(ptr);
+	}
+
 	VariablePtr NodeManager::buildOffset(const TypePtr& type) {
 		auto ptr = std::make_shared<Variable>(Value::VC_Temporary, Value::VT_Memory, type, getUniqueTemporaryName());
 		return values.add(ptr);
@@ -109,13 +117,18 @@ namespace core {
 	}
 
 	ValuePtr NodeManager::buildIntConstant(int value) {
-		auto ptr = std::make_shared<IntConstant>(value);
-		return values.add(ptr);
+		auto& constant = intConstants[value];
+		if (!constant) constant = std::make_shared<IntConstant>(buildBasicType(Type::TI_Int), value);
+		return constant;
 	}
 
 	ValuePtr NodeManager::buildFloatConstant(float value) {
-		auto ptr = std::make_shared<FloatConstant>(value);
-		return values.add(ptr);
+		// keyed by the bit pattern, hence -0.0f and 0.0f remain distinct
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		auto& constant = floatConstants[bits];
+		if (!constant) constant = std::make_shared<FloatConstant>(buildBasicType(Type::TI_Float), value);
+		return constant;
 	}
 
 	AssignInsnPtr NodeManager::buildAssign(const VariablePtr& lhs, const ValuePtr& rhs1) {
@@ -180,6 +193,10 @@ namespace core {
 		return std::make_shared<CallInsn>(callee, result);
 	}
 
+	BasicBlockPtr NodeManager::buildBasicBlock() {
+		return std::make_shared<BasicBlock>();
+	}
+
 	std::ostream& NodeManager::printTo(std::ostream& stream) const {
 		return getProgram()->printTo(stream);
 	}
@@ -190,7 +207,7 @@ namespace core {
 		// now check all instructions for validity
 		if (getInsns().empty()) return true;
 
-		auto last = getInsns().end() - 1;
+		auto last = std::prev(getInsns().end());
 		auto it = std::find_if(getInsns().begin(), last,
 			[&](const InsnPtr& insn) { return insn->getInsnCategory() == Insn::IC_Termination; });
 		// in this case we have a termination insn within the insn stream!
@@ -247,10 +264,6 @@ namespace core {
 		return stream << ")";
 	}
 
-	void Variable::setSSAIndex(unsigned index) {
-		ssaIndex = index;
-	}
-
 	std::string Variable::getName() const {
 		if (hasSSAIndex())
 			return name + "." + std::to_string(ssaIndex);
@@ -260,12 +273,14 @@ namespace core {
 
 	bool Variable::operator==(const Node& other) const {
 		if (typeid(Variable) != typeid(other)) return false;
-		return name == static_cast<const Variable&>(other).name;
+		const auto& var = static_cast<const Variable&>(other);
+		return name == var.name && ssaIndex == var.ssaIndex;
 	}
 
 	bool Variable::operator <(const Value& rhs) const {
 		if (typeid(Variable) != typeid(rhs)) return false;
-		return name < static_cast<const Variable&>(rhs).name;
+		const auto& var = static_cast<const Variable&>(rhs);
+		return name < var.name || (name == var.name && ssaIndex < var.ssaIndex);
 	}
 
 	std::ostream& Variable::printTo(std::ostream& stream) const {
@@ -327,8 +342,10 @@ namespace core {
 	}
 
 	void FalseJumpInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
-		if (detail::replaceIf(cond, target, replacement)) return;
-		if (detail::replaceIf(this->target, target, replacement)) return;
+		update([&] {
+			if (detail::replaceIf(cond, target, replacement)) return;
+			detail::replaceIf(this->target, target, replacement);
+		});
 	}
 
 	bool FalseJumpInsn::operator==(const Node& other) const {
@@ -407,8 +424,17 @@ namespace core {
 	}
 
 	void AssignInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
-		if (detail::replaceIf(rhs1, target, replacement)) return;
-		if (detail::replaceIf(rhs2, target, replacement)) return;
+		update([&] {
+			// both operands may refer to the same node
+			detail::replaceIf(rhs1, target, replacement);
+			detail::replaceIf(rhs2, target, replacement);
+		});
+	}
+
+	void PhiInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
+		update([&] {
+			for (auto& var : rhs) detail::replaceIf(var, target, replacement);
+		});
 	}
 
 	bool PhiInsn::operator==(const Node& other) const {
@@ -432,7 +458,7 @@ namespace core {
 	}
 
 	void ReturnInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
-		detail::replaceIf(rhs, target, replacement);
+		update([&] { detail::replaceIf(rhs, target, replacement); });
 	}
 
 	bool ReturnInsn::operator==(const Node& other) const {
@@ -451,7 +477,7 @@ namespace core {
 	}
 
 	void PushInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
-		detail::replaceIf(rhs, target, replacement);
+		update([&] { detail::replaceIf(rhs, target, replacement); });
 	}
 
 	bool PushInsn::operator==(const Node& other) const {
@@ -474,7 +500,7 @@ namespace core {
 	}
 
 	void PopInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
-		detail::replaceIf(rhs, target, replacement);
+		update([&] { detail::replaceIf(rhs, target, replacement); });
 	}
 
 	bool PopInsn::operator==(const Node& other) const {
@@ -495,6 +521,10 @@ namespace core {
 		assert(analysis::types::hasReturn(callee->getType()) && "callee must return a value");
 	}
 
+	void CallInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
+		update([&] { detail::replaceIf(result, target, replacement); });
+	}
+
 	bool CallInsn::operator==(const Node& other) const {
 		if (typeid(CallInsn) != typeid(other)) return false;
 
@@ -524,6 +554,14 @@ namespace core {
 		}
 	}
 
+	void AllocaInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
+		update([&] {
+			// the dimensions make up the size, thus keep them in sync
+			detail::replaceIf(size, target, replacement);
+			for (auto& dim : dimensions) detail::replaceIf(dim, target, replacement);
+		});
+	}
+
 	bool AllocaInsn::operator==(const Node& other) const {
 		if (typeid(AllocaInsn) != typeid(other)) return false;
 
@@ -540,8 +578,10 @@ namespace core {
 	}
 
 	void LoadInsn::replaceNode(const NodePtr &target, const NodePtr &replacement) {
-		if (detail::replaceIf(source, target, replacement)) return;
-		if (detail::replaceIf(this->target, target, replacement)) return;
+		update([&] {
+			if (detail::replaceIf(source, target, replacement)) return;
+			detail::replaceIf(this->target, target, replacement);
+		});
 	}
 
 	bool LoadInsn::operator==(const Node& other) const {
@@ -559,8 +599,10 @@ namespace core {
 	}
 
 	void StoreInsn::replaceNode(const NodePtr &target, const NodePtr &replacement) {
-		if (detail::replaceIf(source, target, replacement)) return;
-		if (detail::replaceIf(this->target, target, replacement)) return;
+		update([&] {
+			if (detail::replaceIf(source, target, replacement)) return;
+			detail::replaceIf(this->target, target, replacement);
+		});
 	}
 
 	bool StoreInsn::operator==(const Node& other) const {
@@ -577,6 +619,10 @@ namespace core {
 		return target->printTo(stream << ",");
 	}
 
+	void PushSpInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
+		update([&] { detail::replaceIf(rhs, target, replacement); });
+	}
+
 	bool PushSpInsn::operator==(const Node& other) const {
 		if (typeid(PushSpInsn) != typeid(other)) return false;
 		if (*rhs != *static_cast<const PushSpInsn&>(other).rhs) return false;
@@ -588,6 +634,10 @@ namespace core {
 		return rhs->printTo(stream);
 	}
 
+	void PopSpInsn::replaceNode(const NodePtr& target, const NodePtr& replacement) {
+		update([&] { detail::replaceIf(rhs, target, replacement); });
+	}
+
 	bool PopSpInsn::operator==(const Node& other) const {
 		if (typeid(PopSpInsn) != typeid(other)) return false;
 		if (*rhs != *static_cast<const PopSpInsn&>(other).rhs) return false;
@@ -599,6 +649,89 @@ namespace core {
 		return rhs->printTo(stream);
 	}
 
+	InsnChain::const_iterator InsnChain::insert(const_iterator pos, const InsnPtr& insn) {
+		assert(insn && !insn->prev && !insn->next && insn != head && "insn is already linked");
+		Insn* succ = pos.node;
+		Insn* pred = succ ? succ->prev : tail;
+		// the slot which currently owns succ will own insn instead
+		auto& slot = pred ? pred->next : head;
+		insn->next = std::move(slot);
+		insn->prev = pred;
+		slot = insn;
+		if (succ) succ->prev = insn.get();
+		else tail = insn.get();
+		++count;
+		insn->linked = true;
+		insn->registerOperands(insn);
+		return const_iterator(this, insn.get());
+	}
+
+	InsnChain::const_iterator InsnChain::erase(const_iterator pos) {
+		Insn* node = pos.node;
+		assert(node && "cannot erase end of chain");
+		node->unregisterOperands(*pos);
+		node->linked = false;
+		Insn* pred = node->prev;
+		auto& slot = pred ? pred->next : head;
+		// keep node alive until it is completely unlinked
+		auto self = std::move(slot);
+		slot = std::move(node->next);
+		Insn* succ = slot.get();
+		if (succ) succ->prev = pred;
+		else tail = pred;
+		node->prev = nullptr;
+		--count;
+		return const_iterator(this, succ);
+	}
+
+	InsnPtr Insn::getSelf() const {
+		assert(linked && "insn is not part of a basic block");
+		return prev ? prev->next : getParent()->getInsns().front();
+	}
+
+	namespace {
+		void removeFrom(InsnList& list, const InsnPtr& insn) {
+			// order does not matter, hence swap with the last one
+			auto it = std::find(list.begin(), list.end(), insn);
+			if (it == list.end()) return;
+			*it = list.back();
+			list.pop_back();
+		}
+	}
+
+	void Insn::registerOperands(const InsnPtr& self) {
+		for (const auto& var : analysis::insn::getInputVars(self)) var->uses.push_back(self);
+		for (const auto& var : analysis::insn::getOutputVars(self)) var->defs.push_back(self);
+	}
+
+	void Insn::unregisterOperands(const InsnPtr& self) {
+		for (const auto& var : analysis::insn::getInputVars(self)) removeFrom(var->uses, self);
+		for (const auto& var : analysis::insn::getOutputVars(self)) removeFrom(var->defs, self);
+	}
+
+	void replaceAllUsesWith(const VariablePtr& var, const ValuePtr& value) {
+		assert(*var != *value && "cannot replace a variable by itself");
+		// detach the list first, thus unregistering a user does not scan it
+		InsnList uses;
+		uses.swap(var->uses);
+		for (const auto& use : uses) use->replaceNode(var, value);
+		// each user re-registers the operands it still reads
+		assert(var->uses.empty() && "not all uses have been replaced");
+	}
+
+	void InsnChain::clear() {
+		// unlink iteratively, a recursive release of the chain may exhaust the stack
+		while (head) {
+			head->unregisterOperands(head);
+			head->linked = false;
+			auto next = std::move(head->next);
+			if (next) next->prev = nullptr;
+			head = std::move(next);
+		}
+		tail = nullptr;
+		count = 0;
+	}
+
 	bool BasicBlock::operator <(const BasicBlock& other) const {
 		return *lbl < *other.lbl;
 	}
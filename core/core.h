@@ -5,6 +5,7 @@
 #include <cassert>
 #include <typeinfo>
 #include <climits>
+#include <cstdint>
 #include <functional>
 
 namespace core {
@@ -178,27 +179,39 @@ namespace core {
 		unsigned ssaIndex;
 		AllocaInsnPtr parent;
 	public:
-		Variable(ValueCategory valueCategory, ValueType valueType, const TypePtr& type, const std::string& name) :
-			Value(valueCategory, valueType, type), name(name), ssaIndex(UINT_MAX)
+		// the ssa index is part of the hash, thus it is fixed once a var is built
+		Variable(ValueCategory valueCategory, ValueType valueType, const TypePtr& type, const std::string& name,
+			unsigned ssaIndex = UINT_MAX) :
+			Value(valueCategory, valueType, type), name(name), ssaIndex(ssaIndex)
 		{ }
 		bool hasSSAIndex() const { return ssaIndex != UINT_MAX; }
 		unsigned getSSAIndex() const { return ssaIndex; }
-		void setSSAIndex(unsigned index);
 		std::string getName() const;
+		const std::string& getBaseName() const { return name; }
 		bool hasParent() const { return parent != nullptr; }
 		const AllocaInsnPtr& getParent() const { assert(hasParent() && "var has no parent"); return parent; }
 		void setParent(const AllocaInsnPtr& parent) { this->parent = parent; }
+		// insns reading resp. writing this variable, maintained by the ir
+		// for all insns which are part of a basic block
+		const InsnList& getUses() const { return uses; }
+		const InsnList& getDefs() const { return defs; }
 		bool operator==(const Node& other) const override;
 		bool operator <(const Value& rhs) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
+	private:
+		friend class Insn;
+		friend void replaceAllUsesWith(const VariablePtr& var, const ValuePtr& value);
+		InsnList uses;
+		InsnList defs;
 	};
 
 	class IntConstant : public Value {
 		int value;
 	public:
-		IntConstant(int value) :
-			Value(VC_Constant, VT_IntConstant, std::make_shared<Type>(Type::TI_Int)), value(value)
-		{ }
+		IntConstant(const TypePtr& type, int value) :
+			Value(VC_Constant, VT_IntConstant, type), value(value) {
+			assert(type->isInt() && "type of an int constant must be int");
+		}
 		int getValue() const { return value; }
 		bool operator==(const Node& other) const override;
 		bool operator <(const Value& rhs) const override;
@@ -208,9 +221,10 @@ namespace core {
 	class FloatConstant : public Value {
 		float value;
 	public:
-		FloatConstant(float value) :
-			Value(VC_Constant, VT_FloatConstant, std::make_shared<Type>(Type::TI_Float)), value(value)
-		{ }
+		FloatConstant(const TypePtr& type, float value) :
+			Value(VC_Constant, VT_FloatConstant, type), value(value) {
+			assert(type->isFloat() && "type of a float constant must be float");
+		}
 		float getValue() const { return value; }
 		bool operator==(const Node& other) const override;
 		bool operator <(const Value& rhs) const override;
@@ -227,14 +241,33 @@ namespace core {
 		bool hasParent() const { return parent != nullptr; }
 		const BasicBlockPtr& getParent() const { assert(hasParent() && "insn has no parent"); return parent; }
 		void setParent(const BasicBlockPtr& parent) { this->parent = parent; }
+		bool isLinked() const { return linked; }
 	protected:
 		Insn(InsnCategory category, InsnType insnType) :
-			Node(NC_Insn), category(category), insnType(insnType)
+			Node(NC_Insn), category(category), insnType(insnType), prev(nullptr), linked(false)
 		{ }
+		// modifies the operands and keeps the use & def lists up to date
+		template<typename Lambda>
+		void update(Lambda lambda) {
+			if (!linked) { lambda(); return; }
+			auto self = getSelf();
+			unregisterOperands(self);
+			lambda();
+			registerOperands(self);
+		}
 	private:
+		friend class InsnChain;
+		InsnPtr getSelf() const;
+		void registerOperands(const InsnPtr& self);
+		void unregisterOperands(const InsnPtr& self);
+
 		InsnCategory category;
 		InsnType insnType;
 		BasicBlockPtr parent;
+		// links within the chain of the parent, next owns its successor
+		InsnPtr next;
+		Insn* prev;
+		bool linked;
 	};
 
 	class AssignInsn : public Insn {
@@ -262,9 +295,9 @@ namespace core {
 		const ValuePtr& getRhs1() const { return rhs1; }
 		const ValuePtr& getRhs2() const { return rhs2; }
 		void setOp(OpType op) { this->op = op; }
-		void setLhs(const VariablePtr& lhs) { this->lhs = lhs; }
-		void setRhs1(const ValuePtr& rhs1) { this->rhs1 = rhs1; }
-		void setRhs2(const ValuePtr& rhs2) { this->rhs2 = rhs2; }
+		void setLhs(const VariablePtr& lhs) { update([&] { this->lhs = lhs; }); }
+		void setRhs1(const ValuePtr& rhs1) { update([&] { this->rhs1 = rhs1; }); }
+		void setRhs2(const ValuePtr& rhs2) { update([&] { this->rhs2 = rhs2; }); }
 		bool operator==(const Node& other) const override;
 		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		std::ostream& printTo(std::ostream& stream) const override;
@@ -327,10 +360,11 @@ namespace core {
 			Insn(IC_SSA, IT_Phi), lhs(lhs), rhs(rhs) {
 			assert(lhs && rhs.size() && "lhs or rhs of phi cannot be null");
 		}
-		void setLhs(const VariablePtr& lhs) { this->lhs = lhs; }
+		void setLhs(const VariablePtr& lhs) { update([&] { this->lhs = lhs; }); }
 		const VariablePtr& getLhs() const { return lhs; }
-		VariableList& getRhs() { return rhs; }
 		const VariableList& getRhs() const { return rhs; }
+		void setRhs(unsigned index, const VariablePtr& var) { update([&] { rhs[index] = var; }); }
+		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
 	};
@@ -384,6 +418,7 @@ namespace core {
 		CallInsn(const FunctionPtr& callee, const VariablePtr& result);
 		const FunctionPtr& getCallee() const { return callee; }
 		const VariablePtr& getResult() const { return result; }
+		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
 	};
@@ -398,6 +433,7 @@ namespace core {
 		const VariablePtr& getVariable() const { return variable; }
 		const ValueList& getDimensions() const { return dimensions; }
 		bool isConst() const { return size->getValueCategory() == Value::VC_Constant; }
+		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
 	};
@@ -412,9 +448,9 @@ namespace core {
 			assert(target && "target must not be null");
 		}
 		const VariablePtr& getSource() const { return source; }
-		void setSource(const VariablePtr& source) { this->source = source; }
+		void setSource(const VariablePtr& source) { update([&] { this->source = source; }); }
 		const VariablePtr& getTarget() const { return target; }
-		void setTarget(const VariablePtr& target) { this->target = target; }
+		void setTarget(const VariablePtr& target) { update([&] { this->target = target; }); }
 		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
@@ -430,9 +466,9 @@ namespace core {
 			assert(target && "target must not be null");
 		}
 		const ValuePtr& getSource() const { return source; }
-		void setSource(const ValuePtr& source) { this->source = source; }
+		void setSource(const ValuePtr& source) { update([&] { this->source = source; }); }
 		const VariablePtr& getTarget() const { return target; }
-		void setTarget(const VariablePtr& target) { this->target = target; }
+		void setTarget(const VariablePtr& target) { update([&] { this->target = target; }); }
 		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
@@ -447,6 +483,7 @@ namespace core {
 			assert(rhs->getType()->isInt() && "rhs must be of type int");
 		}
 		const VariablePtr& getRhs() const { return rhs; }
+		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
 	};
@@ -460,18 +497,86 @@ namespace core {
 			assert(rhs->getType()->isInt() && "rhs must be of type int");
 		}
 		const VariablePtr& getRhs() const { return rhs; }
+		void replaceNode(const NodePtr& target, const NodePtr& replacement) override;
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
 	};
 
+	// doubly linked list of insns whose links are stored within the insns
+	// themselves, insertion and removal take O(1) and never invalidate
+	// iterators referring to other insns of the chain
+	class InsnChain {
+	public:
+		class const_iterator {
+		public:
+			typedef std::bidirectional_iterator_tag iterator_category;
+			typedef InsnPtr value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const InsnPtr* pointer;
+			typedef const InsnPtr& reference;
+
+			const_iterator() : chain(nullptr), node(nullptr) { }
+			// the owning pointer of a node is held by its predecessor resp. the head
+			reference operator*() const { return node->prev ? node->prev->next : chain->head; }
+			pointer operator->() const { return &**this; }
+			const_iterator& operator++() { node = node->next.get(); return *this; }
+			const_iterator operator++(int) { auto tmp = *this; ++*this; return tmp; }
+			const_iterator& operator--() { node = node ? node->prev : chain->tail; return *this; }
+			const_iterator operator--(int) { auto tmp = *this; --*this; return tmp; }
+			bool operator==(const const_iterator& other) const { return node == other.node; }
+			bool operator!=(const const_iterator& other) const { return node != other.node; }
+		private:
+			friend class InsnChain;
+			const_iterator(const InsnChain* chain, Insn* node) : chain(chain), node(node) { }
+			const InsnChain* chain;
+			Insn* node;
+		};
+		typedef const_iterator iterator;
+		typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+		typedef const_reverse_iterator reverse_iterator;
+
+		InsnChain() : tail(nullptr), count(0) { }
+		InsnChain(const InsnChain&) = delete;
+		InsnChain& operator=(const InsnChain&) = delete;
+		~InsnChain() { clear(); }
+
+		const_iterator begin() const { return const_iterator(this, head.get()); }
+		const_iterator end() const { return const_iterator(this, nullptr); }
+		const_iterator cbegin() const { return begin(); }
+		const_iterator cend() const { return end(); }
+		const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+		const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+		const_reverse_iterator crbegin() const { return rbegin(); }
+		const_reverse_iterator crend() const { return rend(); }
+		size_t size() const { return count; }
+		bool empty() const { return !count; }
+		const InsnPtr& front() const { assert(!empty() && "chain is empty"); return head; }
+		const InsnPtr& back() const { assert(!empty() && "chain is empty"); return *--end(); }
+
+		// position of an insn which is part of this chain
+		const_iterator find(const InsnPtr& insn) const { return const_iterator(this, insn.get()); }
+
+		// inserts insn in front of pos and returns its position
+		const_iterator insert(const_iterator pos, const InsnPtr& insn);
+		// unlinks the insn at pos and returns the position of its successor
+		const_iterator erase(const_iterator pos);
+		void push_back(const InsnPtr& insn) { insert(end(), insn); }
+		void push_front(const InsnPtr& insn) { insert(begin(), insn); }
+		void clear();
+	private:
+		InsnPtr head;
+		Insn* tail;
+		size_t count;
+	};
+
 	class BasicBlock : public Printable {
 		LabelInsnPtr lbl;
-		InsnList insns;
+		InsnChain insns;
 		FunctionPtr parent;
 	public:
 		const LabelInsnPtr& getLabel() const { return lbl; }
 		void setLabel(const LabelInsnPtr& lbl) { this->lbl = lbl; }
-		const InsnList& getInsns() const { return insns; }
+		const InsnChain& getInsns() const { return insns; }
 		bool isValid() const;
 		bool hasParent() const { return parent != nullptr; }
 		const FunctionPtr& getParent() const { assert(hasParent() && "bb has no parent"); return parent; }
@@ -485,12 +590,20 @@ namespace core {
 			insn->setParent(bb);
 		}
 		static void prepend(const BasicBlockPtr& bb, const InsnPtr& insn) {
-			bb->insns.insert(bb->insns.begin(), insn);
+			bb->insns.push_front(insn);
 			insn->setParent(bb);
 		}
-		static InsnList::iterator remove(const BasicBlockPtr& bb, const InsnList::const_iterator& it) {
+		static InsnChain::iterator insert(const BasicBlockPtr& bb, const InsnChain::const_iterator& it, const InsnPtr& insn) {
+			insn->setParent(bb);
+			return bb->insns.insert(it, insn);
+		}
+		static InsnChain::iterator remove(const BasicBlockPtr& bb, const InsnChain::const_iterator& it) {
 			return bb->insns.erase(it);
 		}
+		// position of an insn within its parent
+		static InsnChain::iterator getPosition(const InsnPtr& insn) {
+			return insn->getParent()->insns.find(insn);
+		}
 	};
 
 	class Function : public Node {
@@ -503,9 +616,7 @@ namespace core {
 		const VariableList& getParameters() const { return parameters; }
 		DirectedGraph<BasicBlock>& getGraph() { return graph; }
 		const DirectedGraph<BasicBlock>& getGraph() const { return graph; }
-		EdgeList& getEdges() { return graph.getEdges(); }
 		const EdgeList& getEdges() const { return graph.getEdges(); }
-		BasicBlockList& getBasicBlocks() { return graph.getVertices(); }
 		const BasicBlockList& getBasicBlocks() const { return graph.getVertices(); }
 		bool operator==(const Node& other) const override;
 		std::ostream& printTo(std::ostream& stream) const override;
@@ -535,6 +646,8 @@ namespace core {
 		FunctionTypePtr buildFunctionType(const TypePtr& returnType, const TypeList& parameterTypes);
 
 		VariablePtr buildVariable(const TypePtr& type, const std::string& name);
+		// another version of var which is told apart by its ssa index
+		VariablePtr buildVariable(const VariablePtr& var, unsigned ssaIndex);
 		VariablePtr buildOffset(const TypePtr& type);
 		VariablePtr buildTemporary(const TypePtr& type);
 		ValuePtr buildIntConstant(int value);
@@ -561,6 +674,8 @@ namespace core {
 		PushSpInsnPtr buildPushSp(const VariablePtr& rhs);
 		PopSpInsnPtr buildPopSp(const VariablePtr& rhs);
 
+		BasicBlockPtr buildBasicBlock();
+
 		ProgramPtr getProgram() const { return program; }
 		std::ostream& printTo(std::ostream& stream) const override;
 	private:
@@ -572,24 +687,71 @@ namespace core {
 		ProgramPtr program;
 		InstanceManager<Value> values;
 		InstanceManager<Type> types;
+		// basic types and constants are interned by key, a hit does not allocate
+		TypePtr basicTypes[Type::TI_Array];
+		std::unordered_map<int, ValuePtr> intConstants;
+		std::unordered_map<uint32_t, ValuePtr> floatConstants;
 	};
 
+	// rewrites each insn reading var to read value instead, takes O(#uses)
+	void replaceAllUsesWith(const VariablePtr& var, const ValuePtr& value);
+
 	bool dumpTo(const ProgramPtr& program, const std::string& dir);
 }
 namespace std {
 	template<>
 	struct hash<core::Type> {
 		size_t operator()(const core::Type& type) const {
-			return static_cast<size_t>(type.getTypeId());
+			size_t result = static_cast<size_t>(type.getTypeId());
+			if (type.isArray()) {
+				const auto& array = static_cast<const core::ArrayType&>(type);
+				return combine_hash(result, (*this)(*array.getElementType()), array.getNumOfDimensions());
+			}
+			if (type.isFunction()) {
+				const auto& fun = static_cast<const core::FunctionType&>(type);
+				result = combine_hash(result, (*this)(*fun.getReturnType()));
+				for (const auto& param : fun.getParameterTypes())
+					result = combine_hash((*this)(*param), result);
+			}
+			return result;
+		}
+	};
+
+	template<>
+	struct hash<core::Variable> {
+		size_t operator()(const core::Variable& var) const {
+			return combine_hash(hash<std::string>()(var.getBaseName()), var.getSSAIndex());
 		}
 	};
 
 	template<>
 	struct hash<core::Value> {
+		// structural, consistent with the operator== of the concrete value
 		size_t operator()(const core::Value& value) const {
-			return combine_hash(hash<core::Type>()(*value.getType()),
-				static_cast<size_t>(value.getValueCategory()),
-				static_cast<size_t>(value.getValueType()));
+			switch (value.getValueType()) {
+			case core::Value::VT_IntConstant:
+				return combine_hash(hash<int>()(static_cast<const core::IntConstant&>(value).getValue()),
+					static_cast<size_t>(core::Value::VT_IntConstant));
+			case core::Value::VT_FloatConstant:
+				return combine_hash(hash<float>()(static_cast<const core::FloatConstant&>(value).getValue()),
+					static_cast<size_t>(core::Value::VT_FloatConstant));
+			default:
+				return hash<core::Variable>()(static_cast<const core::Variable&>(value));
+			}
+		}
+	};
+
+	template<>
+	struct hash<core::BasicBlock> {
+		size_t operator()(const core::BasicBlock& bb) const {
+			return hash<std::string>()(bb.getLabel()->getName());
+		}
+	};
+
+	template<>
+	struct hash<core::Function> {
+		size_t operator()(const core::Function& fun) const {
+			return hash<std::string>()(fun.getName());
 		}
 	};
 }
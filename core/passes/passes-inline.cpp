@@ -26,7 +26,7 @@ namespace passes {
 		// and transform them into:
 		// vN = rhs
 		const auto& insns = bb->getInsns();
-		auto transform = [&](InsnList::const_iterator& curr) -> bool {
+		auto transform = [&](InsnChain::const_iterator& curr) -> bool {
 			if (!analysis::insn::isAssignInsn(*curr)) return false;
 			// take a look at the next one
 			auto next = std::next(curr);
@@ -1,6 +1,15 @@
 #include "core/passes/passes.h"
+#include "core/analysis/analysis.h"
+#include "core/analysis/analysis-types.h"
+#include "core/analysis/analysis-controlflow.h"
+#include "core/analysis/analysis-insn.h"
 #include "core/analysis/analysis-loop.h"
 #include "core/analysis/analysis-callgraph.h"
+#include "core/arithmetic/arithmetic.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <unordered_set>
 
 namespace core {
 namespace passes {
@@ -77,5 +86,573 @@ namespace passes {
     for (const auto& loop : loops)
 			detail::checkDependency(manager, loop, parent);
   }
+
+	namespace {
+		// the array an address is computed from, as long as it can be traced back
+		VariablePtr getArray(const VariablePtr& var) {
+			if (analysis::types::isArray(var->getType())) return var;
+			const auto& defs = var->getDefs();
+			if (defs.size() != 1 || !analysis::insn::isAssignInsn(defs.front())) return nullptr;
+			auto assign = cast<AssignInsn>(defs.front());
+			if (!assign->isAssign() && assign->getOp() != AssignInsn::ADD) return nullptr;
+			for (const auto& value : { assign->getRhs1(), assign->getRhs2() }) {
+				if (!analysis::isVariable(value)) continue;
+				auto rhs = cast<Variable>(value);
+				if (analysis::isOffset(rhs) || analysis::types::isArray(rhs->getType())) return getArray(rhs);
+			}
+			return nullptr;
+		}
+
+		// an int division traps on a zero divisor resp. an overflow, thus it is solely
+		// executed in advance by a constant which does neither
+		bool mayTrap(const AssignInsnPtr& assign) {
+			if (assign->getOp() != AssignInsn::DIV || !analysis::types::isInt(assign->getLhs()->getType())) return false;
+			if (!analysis::isIntConstant(assign->getRhs2())) return true;
+			auto value = cast<IntConstant>(assign->getRhs2())->getValue();
+			return value == 0 || value == -1;
+		}
+
+		// the insn is placed in front of the jump terminating bb
+		void placeAtEnd(const BasicBlockPtr& bb, const InsnPtr& insn) {
+			const auto& insns = bb->getInsns();
+			auto pos = insns.end();
+			if (!insns.empty() && analysis::insn::getJumpTarget(insns.back())) --pos;
+			BasicBlock::insert(bb, pos, insn);
+		}
+
+		void collectLoops(const analysis::loop::LoopList& loops, analysis::loop::LoopList& result) {
+			for (const auto& loop : loops) {
+				collectLoops(loop->getChildren(), result);
+				result.push_back(loop);
+			}
+		}
+
+		// the bb entering a loop header unconditionally from outside of the loop. if there
+		// is none, a new one takes over all outer edges along with the phi operands of these
+		BasicBlockPtr makePreheader(NodeManager& manager, const FunctionPtr& fun,
+			const BasicBlockPtr& header, const std::unordered_set<BasicBlockPtr>& body) {
+			auto before = analysis::controlflow::getPredecessors(fun, header);
+			BasicBlockList entries;
+			for (const auto& pred : before)
+				if (!body.count(pred)) entries.push_back(pred);
+			assert(!entries.empty() && "a loop must be entered from outside");
+			if (entries.size() == 1 && analysis::controlflow::getSuccessors(fun, entries.front()).size() == 1)
+				return entries.front();
+
+			auto bb = manager.buildBasicBlock();
+			bb->setLabel(manager.buildLabel());
+			bb->setParent(fun);
+			auto& graph = fun->getGraph();
+			graph.addVertex(bb);
+			for (const auto& pred : entries) {
+				const auto& insns = pred->getInsns();
+				if (!insns.empty() && detail::isJumpTo(insns.back(), header))
+					insns.back()->replaceNode(header->getLabel(), bb->getLabel());
+				graph.removeEdge(pred, header);
+				graph.addEdge(pred, bb);
+			}
+			graph.addEdge(bb, header);
+			// the goto is dropped by anchoring as long as the header is not placed otherwise
+			BasicBlock::append(bb, manager.buildGoto(header->getLabel()));
+
+			auto getOperand = [&](const PhiInsnPtr& phi, const BasicBlockPtr& pred) {
+				auto it = std::find_if(before.begin(), before.end(),
+					[&](const BasicBlockPtr& cur) { return *cur == *pred; });
+				assert(it != before.end() && "a phi lacks the operand of an edge");
+				return phi->getRhs()[it - before.begin()];
+			};
+			auto entered = analysis::controlflow::getPredecessors(fun, bb);
+			auto preds = analysis::controlflow::getPredecessors(fun, header);
+			for (const auto& phi : detail::getPhis(header)) {
+				VariableList rhs;
+				for (const auto& pred : entered) rhs.push_back(getOperand(phi, pred));
+				// distinct values entering the loop meet in a new version of the preheader
+				auto value = rhs.front();
+				if (std::any_of(rhs.begin(), rhs.end(), [&](const VariablePtr& var) { return *var != *value; })) {
+					unsigned index = 0;
+					for (const auto& var : analysis::controlflow::getAllVars(fun)) {
+						if (var->hasSSAIndex() && var->getBaseName() == value->getBaseName())
+							index = std::max(index, var->getSSAIndex());
+					}
+					value = manager.buildVariable(phi->getLhs(), index + 1);
+					BasicBlock::prepend(bb, manager.buildPhi(value, rhs));
+				}
+
+				VariableList operands;
+				for (const auto& pred : preds)
+					operands.push_back(*pred == *bb ? value : getOperand(phi, pred));
+				auto pos = BasicBlock::getPosition(phi);
+				BasicBlock::insert(header, pos, manager.buildPhi(phi->getLhs(), operands));
+				BasicBlock::remove(header, pos);
+			}
+			return bb;
+		}
+
+		// a loop is recovered from the layout, thus it is only taken as is if each of its
+		// bbs is dominated by the header. a new preheader belongs to the enclosing loops
+		class LoopNest {
+			analysis::controlflow::DominatorTree dominators;
+			// inner loops are listed ahead of the outer ones
+			analysis::loop::LoopList loops;
+			std::unordered_map<analysis::loop::LoopPtr, std::unordered_set<BasicBlockPtr>> bodies;
+			std::unordered_map<analysis::loop::LoopPtr, BasicBlockPtr> preheaders;
+		public:
+			LoopNest(NodeManager& manager, const FunctionPtr& fun) :
+				dominators(analysis::controlflow::getDominatorTree(fun)) {
+				collectLoops(analysis::loop::findLoops(manager, fun, analysis::controlflow::getLinearBasicBlockList(fun), false), loops);
+				for (const auto& loop : loops) {
+					const auto& bbs = loop->getBasicBlocks();
+					bodies[loop].insert(bbs.begin(), bbs.end());
+				}
+				for (const auto& loop : loops) {
+					const auto& bbs = loop->getBasicBlocks();
+					const auto& header = bbs.front();
+					if (!std::all_of(bbs.begin(), bbs.end(),
+						[&](const BasicBlockPtr& bb) { return dominators.dominates(header, bb); })) continue;
+					auto preheader = makePreheader(manager, fun, header, bodies[loop]);
+					preheaders[loop] = preheader;
+					for (auto parent = loop->getParent(); parent; parent = parent->getParent())
+						bodies[parent].insert(preheader);
+				}
+				if (!preheaders.empty()) dominators = analysis::controlflow::getDominatorTree(fun);
+			}
+
+			const analysis::controlflow::DominatorTree& getDominators() const { return dominators; }
+			const analysis::loop::LoopList& getLoops() const { return loops; }
+			const std::unordered_set<BasicBlockPtr>& getBody(const analysis::loop::LoopPtr& loop) const { return bodies.at(loop); }
+			bool hasPreheader(const analysis::loop::LoopPtr& loop) const { return preheaders.count(loop) > 0; }
+			const BasicBlockPtr& getPreheader(const analysis::loop::LoopPtr& loop) const { return preheaders.at(loop); }
+
+			// a value is invariant if none of its defs is part of the loop, the single def
+			// of a version resp. temporary has to reach the preheader as well
+			bool isInvariant(const analysis::loop::LoopPtr& loop, const ValuePtr& value) const {
+				if (!analysis::isVariable(value)) return true;
+				auto var = cast<Variable>(value);
+				const auto& body = getBody(loop);
+				const auto& preheader = getPreheader(loop);
+				bool single = var->hasSSAIndex() || !analysis::isMemory(var);
+				return std::none_of(var->getDefs().begin(), var->getDefs().end(), [&](const InsnPtr& def) {
+					const auto& bb = def->getParent();
+					return body.count(bb) || (single && !dominators.dominates(bb, preheader));
+				});
+			}
+		};
+
+		// an induction var is an affine function of a basic one, the steps apply it to the
+		// basic var. the other operand of each step is loop invariant
+		struct Induction {
+			struct Step {
+				AssignInsn::OpType op;
+				ValuePtr value;
+				// whether the induction var is the lhs of op
+				bool lhs;
+			};
+			VariablePtr basic;
+			std::vector<Step> steps;
+			// the vars computed on the way from the basic var up to this one
+			VariableList chain;
+
+			bool isScaled() const {
+				return std::any_of(steps.begin(), steps.end(),
+					[](const Step& step) { return step.op == AssignInsn::MUL; });
+			}
+
+			// whether the function is strictly increasing, thus it preserves comparisons
+			bool isAscending() const {
+				bool positive = true;
+				for (const auto& step : steps) {
+					if (step.op != AssignInsn::MUL) continue;
+					if (!analysis::isIntConstant(step.value)) return false;
+					auto value = cast<IntConstant>(step.value)->getValue();
+					if (value == 0) return false;
+					if (value < 0) positive = !positive;
+				}
+				return positive;
+			}
+
+			// maps a value of the basic var, unless a step is not constant or leaves the
+			// range of int. the induction var is the lhs of each sub
+			optional<int> map(long long value) const {
+				if (value < INT_MIN || value > INT_MAX) return {};
+				for (const auto& step : steps) {
+					if (!analysis::isIntConstant(step.value)) return {};
+					long long operand = cast<IntConstant>(step.value)->getValue();
+					switch (step.op) {
+					case AssignInsn::ADD: value += operand; break;
+					case AssignInsn::SUB: value -= operand; break;
+					default:              value *= operand; break;
+					}
+					if (value < INT_MIN || value > INT_MAX) return {};
+				}
+				return static_cast<int>(value);
+			}
+		};
+
+		// a basic induction var is a phi of the loop header, which is incremented by a
+		// constant step in each iteration
+		struct BasicInduction {
+			PhiInsnPtr phi;
+			AssignInsnPtr increment;
+			ValuePtr step;
+		};
+
+		bool isIntConstant(const ValuePtr& value, int constant) {
+			return analysis::isIntConstant(value) && cast<IntConstant>(value)->getValue() == constant;
+		}
+
+		// the entry value of a phi is a version, even if it is a mere constant
+		ValuePtr foldCopy(const ValuePtr& value) {
+			if (!analysis::isVariable(value) || cast<Variable>(value)->getDefs().size() != 1) return value;
+			const auto& def = cast<Variable>(value)->getDefs().front();
+			if (analysis::insn::isAssignInsn(def) && cast<AssignInsn>(def)->isAssign() &&
+				analysis::isConstant(cast<AssignInsn>(def)->getRhs1())) return cast<AssignInsn>(def)->getRhs1();
+			return value;
+		}
+
+		bool isComparison(AssignInsn::OpType op) {
+			switch (op) {
+			case AssignInsn::EQ:
+			case AssignInsn::NE:
+			case AssignInsn::LE:
+			case AssignInsn::GE:
+			case AssignInsn::LT:
+			case AssignInsn::GT:
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		// the values an induction var starts with resp. is bumped by are computed ahead of
+		// the loop, as far out as their operands permit. constants are folded right away
+		class Preheader {
+			NodeManager& manager;
+			const LoopNest& nest;
+			const analysis::loop::LoopPtr& loop;
+			// the same scaling is asked for by several induction vars
+			std::vector<AssignInsnPtr> emitted;
+		public:
+			Preheader(NodeManager& manager, const LoopNest& nest, const analysis::loop::LoopPtr& loop) :
+				manager(manager), nest(nest), loop(loop) {}
+
+			ValuePtr emit(AssignInsn::OpType op, const ValuePtr& lhs, const ValuePtr& rhs) {
+				if (analysis::isConstant(lhs) && analysis::isConstant(rhs)) return arithmetic::evaluate(manager, op, lhs, rhs);
+				if (op == AssignInsn::MUL && (isIntConstant(lhs, 0) || isIntConstant(rhs, 0))) return manager.buildIntConstant(0);
+				if (op == AssignInsn::MUL && isIntConstant(lhs, 1)) return rhs;
+				if (op == AssignInsn::MUL && isIntConstant(rhs, 1)) return lhs;
+				if (op == AssignInsn::ADD && isIntConstant(lhs, 0)) return rhs;
+				if (op != AssignInsn::MUL && isIntConstant(rhs, 0)) return lhs;
+				for (const auto& insn : emitted) {
+					if (insn->getOp() == op && *insn->getRhs1() == *lhs && *insn->getRhs2() == *rhs) return insn->getLhs();
+				}
+				auto target = loop;
+				for (auto parent = loop->getParent(); parent && nest.hasPreheader(parent) &&
+					nest.isInvariant(parent, lhs) && nest.isInvariant(parent, rhs); parent = parent->getParent())
+					target = parent;
+				auto var = manager.buildTemporary(analysis::isVariable(lhs) ? lhs->getType() : rhs->getType());
+				auto insn = manager.buildAssign(op, var, lhs, rhs);
+				placeAtEnd(nest.getPreheader(target), insn);
+				emitted.push_back(insn);
+				return var;
+			}
+
+			ValuePtr apply(const Induction& induction, const ValuePtr& value) {
+				auto result = foldCopy(value);
+				for (const auto& step : induction.steps)
+					result = step.lhs ? emit(step.op, result, step.value) : emit(step.op, step.value, result);
+				return result;
+			}
+
+			// the amount the induction var changes by per unit of the basic var
+			ValuePtr getFactor(const Induction& induction) {
+				ValuePtr result = manager.buildIntConstant(1);
+				for (const auto& step : induction.steps)
+					if (step.op == AssignInsn::MUL) result = emit(AssignInsn::MUL, result, step.value);
+				return result;
+			}
+		};
+	}
+
+	void LoopInvariantCodeMotionPass::apply(const FunctionPtr& fun) {
+		if (fun->getGraph().empty()) return;
+		LoopNest nest(manager, fun);
+		for (const auto& loop : nest.getLoops()) {
+			if (!nest.hasPreheader(loop)) continue;
+			const auto& preheader = nest.getPreheader(loop);
+			const auto& header = loop->getBasicBlocks().front();
+			const auto& body = nest.getBody(loop);
+			BasicBlockList latches;
+			for (const auto& pred : analysis::controlflow::getPredecessors(fun, header))
+				if (body.count(pred)) latches.push_back(pred);
+
+			// arrays stored to within the loop, a store which cannot be traced clobbers all
+			VariableSet stored;
+			bool clobbered = false;
+			for (const auto& bb : fun->getBasicBlocks()) {
+				if (!body.count(bb)) continue;
+				for (const auto& insn : bb->getInsns()) {
+					if (!analysis::insn::isStoreInsn(insn)) continue;
+					auto array = getArray(cast<StoreInsn>(insn)->getTarget());
+					if (array) stored.insert(array);
+					else       clobbered = true;
+				}
+			}
+
+			auto isLoopInvariant = [&](const ValuePtr& value) { return nest.isInvariant(loop, value); };
+			// the def of a version is moved ahead of its var's alloca otherwise
+			auto isMovable = [&](const VariablePtr& lhs) {
+				if (lhs->getDefs().size() != 1) return false;
+				if (!lhs->hasSSAIndex()) return !analysis::isMemory(lhs);
+				auto var = manager.buildVariable(lhs->getType(), lhs->getBaseName());
+				return !var->hasParent() || !var->getParent()->isLinked() || !body.count(var->getParent()->getParent());
+			};
+			auto isLocal = [&](const VariablePtr& array) {
+				if (!array || stored.count(array) || !array->hasParent()) return false;
+				const auto& uses = array->getUses();
+				return !body.count(array->getParent()->getParent()) &&
+					std::none_of(uses.begin(), uses.end(), analysis::insn::isPushInsn);
+			};
+			auto isHoistable = [&](const InsnPtr& insn) {
+				if (analysis::insn::isAssignInsn(insn)) {
+					auto assign = cast<AssignInsn>(insn);
+					// a copy costs less than the live range of its lhs across the loop
+					if (assign->isAssign() || mayTrap(assign) || !isMovable(assign->getLhs())) return false;
+					return isLoopInvariant(assign->getRhs1()) && isLoopInvariant(assign->getRhs2());
+				}
+				if (!analysis::insn::isLoadInsn(insn) || clobbered) return false;
+				auto load = cast<LoadInsn>(insn);
+				if (!isMovable(load->getTarget()) || !isLoopInvariant(load->getSource())) return false;
+				// a load which is not executed in each iteration might fault in advance
+				const auto& bb = insn->getParent();
+				return std::all_of(latches.begin(), latches.end(),
+					[&](const BasicBlockPtr& latch) { return nest.getDominators().dominates(bb, latch); }) &&
+					isLocal(getArray(load->getSource()));
+			};
+
+			// hoisting an insn may render the ones reading its lhs invariant
+			unsigned count = 0;
+			for (bool changed = true; changed; ) {
+				InsnList invariants;
+				for (const auto& bb : fun->getBasicBlocks()) {
+					if (!body.count(bb)) continue;
+					for (const auto& insn : bb->getInsns())
+						if (isHoistable(insn)) invariants.push_back(insn);
+				}
+				for (const auto& insn : invariants) {
+					BasicBlock::remove(insn->getParent(), BasicBlock::getPosition(insn));
+					placeAtEnd(preheader, insn);
+				}
+				count += invariants.size();
+				changed = !invariants.empty();
+			}
+
+			report.push_back(std::make_pair(header->getLabel(), count));
+			if (verbose) std::cout << fun->getName() << ": loop " << header->getLabel()->getName()
+				<< " hoisted " << count << " insns" << std::endl;
+		}
+		detail::anchorBasicBlocks(fun);
+	}
+
+	void LoopInvariantCodeMotionPass::apply() {
+		for (const auto& fun : manager.getProgram()->getFunctions())
+			apply(fun);
+	}
+
+	void InductionVariableStrengthReductionPass::apply(const FunctionPtr& fun) {
+		if (fun->getGraph().empty()) return;
+		LoopNest nest(manager, fun);
+		for (const auto& loop : nest.getLoops()) {
+			if (!nest.hasPreheader(loop)) continue;
+			const auto& preheader = nest.getPreheader(loop);
+			const auto& header = loop->getBasicBlocks().front();
+			const auto& body = nest.getBody(loop);
+			BasicBlockList latches;
+			for (const auto& pred : analysis::controlflow::getPredecessors(fun, header))
+				if (body.count(pred)) latches.push_back(pred);
+			if (latches.size() != 1) continue;
+			const auto& latch = latches.front();
+			unsigned entry = detail::getPredecessorIndex(fun, header, preheader);
+			unsigned back = detail::getPredecessorIndex(fun, header, latch);
+
+			std::map<VariablePtr, BasicInduction, target_less<Variable>> basics;
+			std::map<VariablePtr, Induction, target_less<Variable>> inductions;
+			for (const auto& phi : detail::getPhis(header)) {
+				const auto& var = phi->getLhs();
+				if (phi->getRhs().size() != 2 || !analysis::types::isInt(var->getType())) continue;
+				const auto& defs = phi->getRhs()[back]->getDefs();
+				if (defs.size() != 1 || !analysis::insn::isAssignInsn(defs.front())) continue;
+				auto increment = cast<AssignInsn>(defs.front());
+				if (!increment->isBinary() || !body.count(increment->getParent())) continue;
+				const auto& rhs1 = increment->getRhs1();
+				const auto& rhs2 = increment->getRhs2();
+				ValuePtr step;
+				if (increment->getOp() == AssignInsn::ADD) {
+					if (*rhs1 == *var && analysis::isIntConstant(rhs2)) step = rhs2;
+					else if (*rhs2 == *var && analysis::isIntConstant(rhs1)) step = rhs1;
+				} else if (increment->getOp() == AssignInsn::SUB && *rhs1 == *var && analysis::isIntConstant(rhs2)) {
+					step = arithmetic::evaluate(manager, AssignInsn::SUB, rhs2);
+				}
+				if (!step) continue;
+				basics[var] = { phi, increment, step };
+				inductions[var] = { var, {}, {} };
+			}
+			if (basics.empty()) continue;
+
+			// derived ones are affine in another induction var, an operand may be defined
+			// further down in the body though
+			for (bool changed = true; changed; ) {
+				changed = false;
+				for (const auto& bb : fun->getBasicBlocks()) {
+					if (!body.count(bb)) continue;
+					for (const auto& insn : bb->getInsns()) {
+						if (!analysis::insn::isAssignInsn(insn)) continue;
+						auto assign = cast<AssignInsn>(insn);
+						const auto& lhs = assign->getLhs();
+						auto op = assign->getOp();
+						if (!assign->isBinary() || inductions.count(lhs)) continue;
+						if (op != AssignInsn::ADD && op != AssignInsn::SUB && op != AssignInsn::MUL) continue;
+						if (!analysis::types::isInt(lhs->getType()) || analysis::isOffset(lhs)) continue;
+						if (lhs->getDefs().size() != 1 || (!lhs->hasSSAIndex() && analysis::isMemory(lhs))) continue;
+
+						auto source = inductions.end();
+						Induction::Step step;
+						if (analysis::isVariable(assign->getRhs1()) && nest.isInvariant(loop, assign->getRhs2())) {
+							source = inductions.find(cast<Variable>(assign->getRhs1()));
+							step = { op, assign->getRhs2(), true };
+						} else if (analysis::isVariable(assign->getRhs2()) && nest.isInvariant(loop, assign->getRhs1()) &&
+							op != AssignInsn::SUB) {
+							source = inductions.find(cast<Variable>(assign->getRhs2()));
+							step = { op, assign->getRhs1(), false };
+						}
+						if (source == inductions.end()) continue;
+						auto induction = source->second;
+						induction.steps.push_back(step);
+						induction.chain.push_back(lhs);
+						inductions[lhs] = induction;
+						changed = true;
+					}
+				}
+			}
+
+			// the insns of an induction var which is not read anymore are removed
+			auto remove = [&](const InsnPtr& insn) {
+				InsnList workList{ insn };
+				while (!workList.empty()) {
+					auto cur = workList.back();
+					workList.pop_back();
+					auto vars = analysis::insn::getInputVars(cur);
+					BasicBlock::remove(cur->getParent(), BasicBlock::getPosition(cur));
+					for (const auto& var : vars) {
+						auto it = inductions.find(var);
+						if (it == inductions.end() || it->second.steps.empty() || !var->getUses().empty()) continue;
+						workList.push_back(var->getDefs().front());
+					}
+				}
+			};
+
+			// a scaled induction var is reduced unless it is solely read by other ones. those
+			// derived from a reduced var merely add to its new phi
+			InsnList candidates;
+			for (const auto& bb : fun->getBasicBlocks()) {
+				if (!body.count(bb)) continue;
+				for (const auto& insn : bb->getInsns()) {
+					auto vo = analysis::insn::getOutputVars(insn);
+					if (vo.size() != 1 || !analysis::insn::isAssignInsn(insn)) continue;
+					auto it = inductions.find(*vo.begin());
+					if (it == inductions.end() || !it->second.isScaled()) continue;
+					const auto& uses = (*vo.begin())->getUses();
+					if (std::any_of(uses.begin(), uses.end(), [&](const InsnPtr& use) {
+						return !analysis::insn::isAssignInsn(use) || !inductions.count(cast<AssignInsn>(use)->getLhs());
+					})) candidates.push_back(insn);
+				}
+			}
+
+			Preheader ahead(manager, nest, loop);
+			VariableSet reduced;
+			std::vector<std::pair<VariablePtr, Induction>> reductions;
+			for (const auto& insn : candidates) {
+				auto lhs = cast<AssignInsn>(insn)->getLhs();
+				const auto& induction = inductions[lhs];
+				if (std::any_of(induction.chain.begin(), induction.chain.end(),
+					[&](const VariablePtr& var) { return reduced.count(var); })) continue;
+				const auto& basic = basics[induction.basic];
+
+				// the versions of a new temporary start ahead of the loop, they are bumped
+				// at the end of the latch. the decoder coalesces them into a single var
+				auto var = manager.buildTemporary(lhs->getType());
+				auto init = manager.buildVariable(var, 1);
+				auto cur = manager.buildVariable(var, 2);
+				auto next = manager.buildVariable(var, 3);
+				placeAtEnd(preheader, manager.buildAssign(init, ahead.apply(induction, basic.phi->getRhs()[entry])));
+				auto step = ahead.emit(AssignInsn::MUL, ahead.getFactor(induction), basic.step);
+				VariableList rhs(2);
+				rhs[entry] = init;
+				rhs[back] = next;
+				BasicBlock::prepend(header, manager.buildPhi(cur, rhs));
+				placeAtEnd(latch, manager.buildAssign(AssignInsn::ADD, next, cur, step));
+
+				replaceAllUsesWith(lhs, cur);
+				remove(insn);
+				reduced.insert(lhs);
+				reductions.push_back(std::make_pair(cur, induction));
+			}
+
+			// linear function test replacement: the exit test compares an ascending reduced
+			// var against the bound mapped likewise. this only pays off if the basic var is
+			// not read apart from the test and its increment, which both die then
+			const auto& insns = header->getInsns();
+			if (reductions.empty() || insns.empty() || !analysis::insn::isFalseJumpInsn(insns.back())) continue;
+			auto cond = cast<FalseJumpInsn>(insns.back())->getCond();
+			if (!analysis::isVariable(cond) || cast<Variable>(cond)->getDefs().size() != 1) continue;
+			const auto& def = cast<Variable>(cond)->getDefs().front();
+			if (!analysis::insn::isAssignInsn(def) || def->getParent() != header) continue;
+			auto test = cast<AssignInsn>(def);
+			if (!test->isBinary() || !isComparison(test->getOp())) continue;
+
+			bool lhs = analysis::isVariable(test->getRhs1()) && basics.count(cast<Variable>(test->getRhs1()));
+			const auto& iv = lhs ? test->getRhs1() : test->getRhs2();
+			const auto& bound = lhs ? test->getRhs2() : test->getRhs1();
+			if (!analysis::isVariable(iv) || !basics.count(cast<Variable>(iv)) || !nest.isInvariant(loop, bound)) continue;
+			const auto& basic = basics[cast<Variable>(iv)];
+			const auto& uses = cast<Variable>(iv)->getUses();
+			if (std::any_of(uses.begin(), uses.end(),
+				[&](const InsnPtr& use) { return use != test && use != basic.increment; })) continue;
+			const auto& next = basic.increment->getLhs();
+			if (next->getUses().size() != 1 || next->getUses().front() != basic.phi) continue;
+			auto it = std::find_if(reductions.begin(), reductions.end(), [&](const std::pair<VariablePtr, Induction>& reduction) {
+				return *reduction.second.basic == *iv && reduction.second.isAscending();
+			});
+			if (it == reductions.end()) continue;
+			// the reduced var wraps where the basic one does not, unless the values the basic
+			// var takes up to the one stepping past the bound map within the range of int
+			auto first = foldCopy(basic.phi->getRhs()[entry]);
+			auto end = foldCopy(bound);
+			if (!analysis::isIntConstant(first) || !analysis::isIntConstant(end)) continue;
+			long long last = cast<IntConstant>(end)->getValue();
+			if (!it->second.map(cast<IntConstant>(first)->getValue()) || !it->second.map(last) ||
+				!it->second.map(last + cast<IntConstant>(basic.step)->getValue())) continue;
+
+			auto limit = ahead.apply(it->second, bound);
+			auto replacement = lhs ? manager.buildAssign(test->getOp(), test->getLhs(), it->first, limit) :
+				manager.buildAssign(test->getOp(), test->getLhs(), limit, it->first);
+			auto pos = BasicBlock::getPosition(test);
+			BasicBlock::insert(header, pos, replacement);
+			BasicBlock::remove(header, pos);
+			BasicBlock::remove(basic.increment->getParent(), BasicBlock::getPosition(basic.increment));
+			BasicBlock::remove(header, BasicBlock::getPosition(basic.phi));
+			// so does the copy of the start value
+			const auto& start = basic.phi->getRhs()[entry];
+			if (start->getUses().empty() && start->getDefs().size() == 1 && analysis::insn::isAssignInsn(start->getDefs().front())) {
+				const auto& insn = start->getDefs().front();
+				BasicBlock::remove(insn->getParent(), BasicBlock::getPosition(insn));
+			}
+		}
+		detail::anchorBasicBlocks(fun);
+	}
+
+	void InductionVariableStrengthReductionPass::apply() {
+		for (const auto& fun : manager.getProgram()->getFunctions())
+			apply(fun);
+	}
 }
 }
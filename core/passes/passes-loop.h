@@ -11,5 +11,35 @@ namespace passes {
 	private:
 		void apply(const FunctionPtr& fun);
 	};
+
+	// assignments whose operands are not defined within a loop and loads of local arrays
+	// the loop does not store to are hoisted into its preheader, which is created unless
+	// the header is entered unconditionally from a single bb. inner loops go first
+	class LoopInvariantCodeMotionPass : public Pass {
+	public:
+		// the label of each loop header along with the number of insns hoisted out of it
+		typedef std::vector<std::pair<LabelInsnPtr, unsigned>> Report;
+		LoopInvariantCodeMotionPass(NodeManager& manager, bool verbose = false) :
+			Pass(manager), verbose(verbose) {}
+		void apply() override;
+		const Report& getReport() const { return report; }
+	private:
+		bool verbose;
+		Report report;
+		void apply(const FunctionPtr& fun);
+	};
+
+	// a basic induction var is a phi of the loop header incremented by a constant, derived
+	// ones are affine in it. a derived var involving a multiplication becomes a phi of its
+	// own, which is bumped by its step instead. the exit test is rewritten against such a
+	// var, thus the basic one dies unless it is read otherwise
+	class InductionVariableStrengthReductionPass : public Pass {
+	public:
+		InductionVariableStrengthReductionPass(NodeManager& manager) :
+			Pass(manager) {}
+		void apply() override;
+	private:
+		void apply(const FunctionPtr& fun);
+	};
 }
 }
@@ -2,98 +2,118 @@
 #include "core/analysis/analysis.h"
 #include "core/analysis/analysis-types.h"
 #include "core/analysis/analysis-controlflow.h"
+#include "core/analysis/analysis-insn.h"
 #include "core/arithmetic/arithmetic.h"
 #include <algorithm>
 
 namespace core {
 namespace passes {
 
-	size_t HashTable::hash(const ValuePtr& val) {
-		if (!val) return 42;
+	constexpr HashTable::Number HashTable::none;
 
-		// check if we know about this value already
-		for (const auto& entry : entries) {
-			if (*entry.value == *val) return entry.number;
-		}
+	HashTable::Number HashTable::number(const ValuePtr& val) {
+		auto res = numbers.insert(std::make_pair(val, next));
+		if (!res.second) return res.first->second;
+		// first occurrence, thus it obtains a fresh number
+		log.push_back(Undo{Undo::UK_Value, val, Key(), none});
+		holders.push_back(nullptr);
+		return next++;
+	}
 
-		size_t base = 0;
-		size_t type = std::hash<unsigned>()(static_cast<unsigned>(val->getType()->getTypeId()));
-		if (val->getValueCategory() == Value::VC_Constant) {
-			if (analysis::types::isInt(val->getType()))
-				base = std::hash<int>()(arithmetic::getValue<int>(val));
-			else if (analysis::types::isFloat(val->getType()))
-				base = std::hash<float>()(arithmetic::getValue<float>(val));
-			else
-				assert(false && "unsupported value for hash");
-		} else {
-			// in this case we face a variable
-			base = std::hash<std::string>()(cast<Variable>(val)->getName());
-		}
-		return combine_hash(base, type);
+	HashTable::Number HashTable::number(const Key& key) {
+		auto res = expressions.insert(std::make_pair(key, next));
+		if (!res.second) return res.first->second;
+		log.push_back(Undo{Undo::UK_Expression, nullptr, key, none});
+		holders.push_back(nullptr);
+		return next++;
 	}
 
-	size_t HashTable::hash(AssignInsn::OpType op) {
-		return static_cast<AssignInsn::OpType>(op);
+	void HashTable::bind(const VariablePtr& var, Number number) {
+		auto it = numbers.find(var);
+		if (it == numbers.end()) {
+			log.push_back(Undo{Undo::UK_Value, var, Key(), none});
+			numbers.insert(std::make_pair(var, number));
+		} else {
+			log.push_back(Undo{Undo::UK_Value, var, Key(), it->second});
+			it->second = number;
+		}
+		// only replace a holder which does not hold the number anymore
+		auto& holder = holders[number];
+		if (holder && numbers.at(holder) == number) return;
+		log.push_back(Undo{Undo::UK_Holder, holder, Key(), number});
+		holder = var;
 	}
 
-	size_t HashTable::hash(AssignInsn::OpType op, const ValuePtr& rhs1, const ValuePtr& rhs2) {
-		auto valOne = rhs1;
-		auto valTwo = rhs2;
-		switch (op) {
+	HashTable::Number HashTable::hash(const AssignInsnPtr& insn) {
+		Number rhs1 = number(insn->getRhs1());
+		Number rhs2 = insn->getRhs2() ? number(insn->getRhs2()) : none;
+		switch (insn->getOp()) {
 		case AssignInsn::ADD:
 		case AssignInsn::MUL:
 		case AssignInsn::EQ:
 		case AssignInsn::NE:
-				if (valOne && valTwo && *valTwo < *valOne)
-					std::swap(valOne, valTwo);
+				if (rhs2 < rhs1) std::swap(rhs1, rhs2);
 				break;
 		default:
 				break;
 		}
-		if (op == AssignInsn::NONE)
-			return combine_hash(valOne ? hash(valOne) : hash(valTwo));
-		else
-			return combine_hash(hash(op), hash(valOne), hash(valTwo));
+		// a copy shares the number of its source
+		Number result = insn->isAssign() ? rhs1 : number(Key{insn->getOp(), rhs1, rhs2});
+		bind(insn->getLhs(), result);
+		return result;
 	}
 
-	size_t HashTable::hash(const AssignInsnPtr& insn) {
-		size_t result = hash(insn->getOp(), insn->getRhs1(), insn->getRhs2());
-		// check if we need to overwrite an entry
-		for (auto& entry : entries) {
-			if (*entry.value != *insn->getLhs()) continue;
-			// ok replace the number
-			entry.number = result;
-			return result;
-		}
-		entries.push_back(Entry{result, insn->getLhs()});
+	HashTable::Number HashTable::kill(const VariablePtr& var) {
+		Number result = next++;
+		holders.push_back(nullptr);
+		bind(var, result);
 		return result;
 	}
 
-	optional<ValuePtr> HashTable::find(size_t number) {
-		for (auto& entry : entries) {
-			if (entry.number == number) return entry.value;
+	optional<ValuePtr> HashTable::find(Number number) const {
+		const auto& holder = holders[number];
+		if (!holder || numbers.at(holder) != number) return {};
+		return holder;
+	}
+
+	void HashTable::rollback(const Mark& mark) {
+		while (log.size() > mark.log) {
+			const auto& undo = log.back();
+			switch (undo.kind) {
+			case Undo::UK_Value:
+				if (undo.number == none) numbers.erase(undo.value);
+				else numbers[undo.value] = undo.number;
+				break;
+			case Undo::UK_Expression:
+				expressions.erase(undo.key);
+				break;
+			case Undo::UK_Holder:
+				holders[undo.number] = undo.value;
+				break;
+			}
+			log.pop_back();
 		}
-		return {};
+		next = mark.next;
+		holders.resize(next);
 	}
 
 	std::ostream& HashTable::printTo(std::ostream& stream) const {
-		for (auto& entry : entries) {
-			entry.value->printTo(stream);
-			stream << " -> " << entry.number << std::endl;
+		for (const auto& entry : numbers) {
+			entry.first->printTo(stream);
+			stream << " -> " << entry.second << std::endl;
 		}
 		return stream;
 	}
 
 	void LocalValueNumberingPass::apply() {
-		for (const auto& fun : manager.getProgram()->getFunctions())
+		for (const auto& fun : manager.getProgram()->getFunctions()) {
+			function = fun;
 			apply(fun);
+		}
 	}
 
 	void LocalValueNumberingPass::apply(const FunctionPtr& fun) {
 		for (auto bb : fun->getBasicBlocks()) {
-			// reset constants
-			clear();
-
 			HashTable table;
 			for (const auto& insn : bb->getInsns())
 				// apply the transformation to each instruction one-per-one
@@ -101,23 +121,40 @@ namespace passes {
 		}
 	}
 
-	void LocalValueNumberingPass::apply(HashTable& table, const InsnPtr& insn) {
-		// replace all constants & vars which we might have computed
-		for (const auto& replacement : replacements)
-			insn->replaceNode(replacement.first, replacement.second);
+	bool LocalValueNumberingPass::isReplaceable(const VariablePtr& var) const {
+		// the value of a parameter is also defined by the caller
+		const auto& params = function->getParameters();
+		if (std::find(params.begin(), params.end(), var) != params.end()) return false;
+		// all uses observe the same value iff there is a single assignment
+		unsigned numOfDefs = 0;
+		for (const auto& def : var->getDefs()) {
+			if (def->getInsnType() != Insn::IT_Alloca) ++numOfDefs;
+		}
+		return numOfDefs == 1;
+	}
 
-		if (insn->getInsnType() != Insn::IT_Assign) return;
+	void LocalValueNumberingPass::apply(HashTable& table, const InsnPtr& insn) {
+		if (insn->getInsnType() != Insn::IT_Assign) {
+			// e.g. loads & calls, their results are not known
+			for (const auto& var : analysis::insn::getOutputVars(insn)) table.kill(var);
+			return;
+		}
 
 		auto assign = cast<AssignInsn>(insn);
-		if (assign->isAssign() && assign->getRhs1()->getValueCategory() == Value::VC_Constant) return;
+		if (assign->isAssign() && assign->getRhs1()->getValueCategory() == Value::VC_Constant) {
+			// constants are propagated as they are, yet the old number is gone
+			table.kill(assign->getLhs());
+			return;
+		}
 		if (assign->isBinary() && arithmetic::isEvaluable(assign->getRhs1(), assign->getRhs2())) {
 			assign->setRhs1(arithmetic::evaluate(manager, assign->getOp(),
 				assign->getRhs1(), assign->getRhs2()));
 			assign->setRhs2(nullptr);
 			assign->setOp(AssignInsn::NONE);
 
-			// save the evaluated constant for later on
-			replacements.insert(std::make_pair(assign->getLhs(), assign->getRhs1()));
+			// propagate the evaluated constant into all users
+			if (isReplaceable(assign->getLhs()))
+				replaceAllUsesWith(assign->getLhs(), assign->getRhs1());
 		}
 
 		auto result = table.find(table.hash(assign));
@@ -135,46 +172,39 @@ namespace passes {
 		assign->setOp(AssignInsn::NONE);
 
 		// in case we alias temporaries, replace that usage and safe insns!
-		if (analysis::isTemporary(assign->getLhs()) && analysis::isTemporary(assign->getRhs1()))
-			// save the rhs1 of the orphan assign for later on
-			replacements.insert(std::make_pair(assign->getLhs(), assign->getRhs1()));
+		if (analysis::isTemporary(assign->getLhs()) && analysis::isTemporary(assign->getRhs1()) &&
+				isReplaceable(assign->getLhs()) && isReplaceable(var))
+			replaceAllUsesWith(assign->getLhs(), assign->getRhs1());
 	}
 
 	void SuperLocalValueNumberingPass::apply() {
-		for (const auto& fun : manager.getProgram()->getFunctions())
+		for (const auto& fun : manager.getProgram()->getFunctions()) {
+			function = fun;
 			apply(fun);
+		}
 	}
 
 	void SuperLocalValueNumberingPass::apply(const FunctionPtr& fun) {
-		auto ebbs = analysis::controlflow::getExtendedBasicBlocks(fun);
-		// reset constants
-		clear();
-
-		BasicBlockList seen;
-		for (const auto& ebb : ebbs) {
+		for (const auto& ebb : analysis::controlflow::getExtendedBasicBlocks(fun)) {
 			HashTable table;
-			apply(fun, table, ebb, ebb[0], seen);
+			// as the ebb is in preorder, a bb is visited after all scopes which are
+			// not opened by its pred have been closed -- thus modifications do not
+			// propagate into other branches of the same ebb!
+			std::vector<std::pair<BasicBlockPtr, HashTable::Mark>> scopes;
+			for (const auto& bb : ebb) {
+				if (!scopes.empty()) {
+					auto pred = analysis::controlflow::getPredecessors(fun, bb).front();
+					while (scopes.back().first != pred) {
+						table.rollback(scopes.back().second);
+						scopes.pop_back();
+					}
+				}
+				scopes.push_back(std::make_pair(bb, table.mark()));
+				for (const auto& insn : bb->getInsns())
+					// invoke local variable numbering
+					LocalValueNumberingPass::apply(table, insn);
+			}
 		}
 	}
-
-	void SuperLocalValueNumberingPass::apply(const FunctionPtr& fun, HashTable& table, const BasicBlockList& ebb,
-																					 const BasicBlockPtr& bb, BasicBlockList& seen) {
-		// check if we have already seen this bb
-		auto seenIt = std::find(seen.begin(), seen.end(), bb);
-		if(seenIt != seen.end()) return;
-		// check if we have reached the end of the ebb
-		auto it = std::find(ebb.begin(), ebb.end(), bb);
-		if (it == ebb.end()) return;
-		// obtain a fresh copy from the parent -- thus modifications do not propagate
-		// into other branches of the same apply!
-		HashTable derived(table);
-		for (const auto& insn : bb->getInsns())
-			// invoke local variable numbering
-			LocalValueNumberingPass::apply(derived, insn);
-		seen.push_back(bb);
-		// now recurse into our successors
-		for (const auto& succ : analysis::controlflow::getSuccessors(fun, bb))
-			apply(fun, derived, ebb, succ, seen);
-	}
 }
 }
@@ -4,23 +4,59 @@
 namespace core {
 namespace passes {
 
+	// maps values and expressions over value numbers to value numbers, all
+	// modifications are logged such that a scope can be left in O(#changes)
 	class HashTable : public Printable {
-		struct Entry {
-			size_t number;
-			ValuePtr value;
+	public:
+		typedef unsigned Number;
+		struct Mark {
+			size_t log;
+			Number next;
 		};
-		std::list<Entry> entries;
 
-		size_t hash(const ValuePtr& val);
-		size_t hash(AssignInsn::OpType op);
-		size_t hash(AssignInsn::OpType op, const ValuePtr& rhs1, const ValuePtr& rhs2);
-	public:
-		HashTable() {}
-		HashTable(const HashTable& other) = default;
-		size_t hash(const AssignInsnPtr& insn);
+		HashTable() : next(0) {}
+		// numbers the rhs of insn and binds the result to its lhs
+		Number hash(const AssignInsnPtr& insn);
+		// binds a fresh number to var, used for all other definitions
+		Number kill(const VariablePtr& var);
+		// a variable which currently holds the given number
+		optional<ValuePtr> find(Number number) const;
 
-		optional<ValuePtr> find(size_t number);
+		Mark mark() const { return Mark{log.size(), next}; }
+		void rollback(const Mark& mark);
 		std::ostream& printTo(std::ostream& stream) const override;
+	private:
+		static constexpr Number none = ~0u;
+		struct Key {
+			AssignInsn::OpType op;
+			Number rhs1;
+			Number rhs2;
+			bool operator==(const Key& other) const {
+				return op == other.op && rhs1 == other.rhs1 && rhs2 == other.rhs2;
+			}
+		};
+		struct key_hash {
+			size_t operator()(const Key& key) const {
+				return combine_hash(static_cast<size_t>(key.op), key.rhs1, key.rhs2);
+			}
+		};
+		struct Undo {
+			enum Kind { UK_Value, UK_Expression, UK_Holder } kind;
+			ValuePtr value;
+			Key key;
+			Number number;
+		};
+
+		std::unordered_map<ValuePtr, Number, target_hash<Value>, target_equal<Value>> numbers;
+		std::unordered_map<Key, Number, key_hash> expressions;
+		// first variable bound to a number, it may have been rebound since
+		std::vector<ValuePtr> holders;
+		std::vector<Undo> log;
+		Number next;
+
+		Number number(const ValuePtr& val);
+		Number number(const Key& key);
+		void bind(const VariablePtr& var, Number number);
 	};
 
 	class LocalValueNumberingPass : public Pass {
@@ -29,11 +65,12 @@ namespace passes {
 			Pass(manager) {}
 		void apply() override;
 	private:
-		PtrMap<Variable, Value> replacements;
 		void apply(const FunctionPtr& fun);
 	protected:
 		void apply(HashTable& table, const InsnPtr& insn);
-		void clear() { replacements.clear(); }
+		// whether all uses of var may be replaced by the value of its definition
+		bool isReplaceable(const VariablePtr& var) const;
+		FunctionPtr function;
 	};
 
 	class SuperLocalValueNumberingPass : public LocalValueNumberingPass {
@@ -43,7 +80,6 @@ namespace passes {
 		void apply() override;
 	private:
 		void apply(const FunctionPtr& fun);
-		void apply(const FunctionPtr& fun, HashTable& table, const BasicBlockList& ebb, const BasicBlockPtr& bb, BasicBlockList& seen);
 	};
 }
 }
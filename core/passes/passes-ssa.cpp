@@ -3,82 +3,614 @@
 #include "core/analysis/analysis-types.h"
 #include "core/analysis/analysis-controlflow.h"
 #include "core/analysis/analysis-insn.h"
+#include "core/arithmetic/arithmetic.h"
 #include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_set>
 
 namespace core {
 namespace passes {
+	namespace {
+		typedef std::map<VariablePtr, VariableSet, target_less<Variable>> Interference;
+		typedef std::vector<std::pair<VariablePtr, VariablePtr>> ParallelCopy;
+		typedef std::pair<BasicBlockPtr, BasicBlockPtr> Edge;
 
-	void SSAEncoderPass::apply(const FunctionPtr& fun) {
-		// compute which bbs have an assignment to vars first
-		std::unordered_map<BasicBlockPtr, VariableSet> modifiedVars;
-		for (const auto& bb: fun->getBasicBlocks()) {
-			modifiedVars.insert(std::make_pair(bb, analysis::controlflow::getModifiedVars(bb)));
+		bool isPhiInsn(const InsnPtr& insn) {
+			return insn->getInsnType() == Insn::IT_Phi;
 		}
+	}
 
-		// compute the dominator & its associated frontier
-		auto dominators = analysis::controlflow::getDominatorMap(fun);
-		auto frontier = analysis::controlflow::getDominatorFrontierMap(fun, dominators);
+	namespace detail {
+		std::vector<PhiInsnPtr> getPhis(const BasicBlockPtr& bb) {
+			std::vector<PhiInsnPtr> result;
+			// phis are always placed on top of a bb
+			for (const auto& insn : bb->getInsns()) {
+				if (!isPhiInsn(insn)) break;
+				result.push_back(cast<PhiInsn>(insn));
+			}
+			return result;
+		}
 
-		typedef analysis::controlflow::DominatorSet WorkList;
-		// iterate over all vars for phi introduction
-		for (const auto& var : analysis::controlflow::getAllVars(fun)) {
-			WorkList hasAlready;
-			WorkList workList;
+		unsigned getPredecessorIndex(const FunctionPtr& fun, const BasicBlockPtr& bb, const BasicBlockPtr& pred) {
+			auto preds = analysis::controlflow::getPredecessors(fun, bb);
+			auto it = std::find_if(preds.begin(), preds.end(),
+				[&](const BasicBlockPtr& cur) { return *cur == *pred; });
+			assert(it != preds.end() && "pred is not connected to bb");
+			return it - preds.begin();
+		}
 
-			// do this vor each node X containing an assignment to V
-			for (const auto& bb: fun->getBasicBlocks()) {
-				auto& value = modifiedVars[bb];
-				auto it = value.find(var);
-				// nope, it's not there
-				if (it == value.end()) continue;
+		bool isJumpTo(const InsnPtr& insn, const BasicBlockPtr& bb) {
+			auto target = analysis::insn::getJumpTarget(insn);
+			return target && **target == *bb->getLabel();
+		}
 
-				workList.insert(bb);
+		// a bb whose fall through pred has been removed may solely be entered by gotos,
+		// which the layout does not follow. such a goto is dropped, thus the bb is placed
+		// right behind its pred
+		void anchorBasicBlocks(const FunctionPtr& fun) {
+			for (;;) {
+				auto layout = analysis::controlflow::getLinearBasicBlockList(fun);
+				if (layout.size() == fun->getBasicBlocks().size()) return;
+				std::unordered_set<BasicBlockPtr> placed(layout.begin(), layout.end());
+				auto it = std::find_if(layout.begin(), layout.end(), [&](const BasicBlockPtr& bb) {
+					auto succs = analysis::controlflow::getSuccessors(fun, bb);
+					return std::any_of(succs.begin(), succs.end(),
+						[&](const BasicBlockPtr& succ) { return !placed.count(succ); });
+				});
+				if (it == layout.end()) return;
+				const auto& insns = (*it)->getInsns();
+				assert(!insns.empty() && analysis::insn::isGotoInsn(insns.back()) && "only gotos are not followed");
+				BasicBlock::remove(*it, std::prev(insns.end()));
 			}
+		}
+	}
 
-			// this loop will terminate if all phi insn for V have been created
-			while (!workList.empty()) {
-				// get the _first_ node within the list and remove it afterwards
-				auto it = workList.begin();
-				auto cur = *it;
-				workList.erase(it);
-
-				for (const auto& bb: frontier[cur]) {
-					auto it = hasAlready.find(bb);
-					// in this case we need to process bb
-					if (it == hasAlready.end()) {
-						bool found = false;
-						auto idom = analysis::controlflow::getImmediateDominator(dominators, bb);
-						auto runner = *idom;
-						while (!found) {
-							auto& value = modifiedVars[runner];
-							auto it = value.find(var);
-							// nope, it's not there
-							if (it != value.end()) {
-								found = true;
-								break;
-							}
-
-							auto next = analysis::controlflow::getImmediateDominator(dominators, runner);
-							if (!next) break;
-
-							// not it is save to prepare the next iteration
-							runner = *next;
+	namespace {
+		// only scalars whose references can all be redirected to a version are renamed,
+		// arrays are addresses and the sp of a dynamic alloca is saved & restored as is
+		bool isRenamable(const VariablePtr& var) {
+			if (!analysis::isMemory(var) || var->hasSSAIndex()) return false;
+			if (analysis::types::isArray(var->getType())) return false;
+			for (const auto& insn : var->getDefs()) {
+				switch (insn->getInsnType()) {
+				case Insn::IT_Assign:
+				case Insn::IT_Load:
+				case Insn::IT_Phi:
+				case Insn::IT_Alloca:
+					break;
+				default:
+					return false;
+				}
+			}
+			for (const auto& insn : var->getUses()) {
+				switch (insn->getInsnType()) {
+				case Insn::IT_Assign:
+				case Insn::IT_Phi:
+				case Insn::IT_Push:
+				case Insn::IT_Return:
+				case Insn::IT_FalseJump:
+				case Insn::IT_Store:
+					break;
+				default:
+					return false;
+				}
+			}
+			return true;
+		}
+
+		class Renamer {
+			NodeManager& manager;
+			const FunctionPtr& fun;
+			const analysis::controlflow::DominatorTree& dominators;
+			const VariableSet& vars;
+			std::map<VariablePtr, unsigned, target_less<Variable>> counters;
+			// the current version of each var, the var itself is the one at the entry
+			std::map<VariablePtr, VariableList, target_less<Variable>> stacks;
+		public:
+			Renamer(NodeManager& manager, const FunctionPtr& fun,
+				const analysis::controlflow::DominatorTree& dominators, const VariableSet& vars) :
+				manager(manager), fun(fun), dominators(dominators), vars(vars) {}
+
+			void rename(const BasicBlockPtr& bb) {
+				VariableList pushed;
+				for (const auto& insn : bb->getInsns()) {
+					if (isPhiInsn(insn)) {
+						auto phi = cast<PhiInsn>(insn);
+						if (vars.count(phi->getLhs())) phi->setLhs(push(phi->getLhs(), pushed));
+						continue;
+					}
+
+					for (const auto& var : analysis::insn::getInputVars(insn))
+						if (vars.count(var)) insn->replaceNode(var, top(var));
+					// an alloca only reserves the slot, thus it remains with the var itself
+					if (analysis::insn::isAllocaInsn(insn)) continue;
+					for (const auto& var : analysis::insn::getOutputVars(insn)) {
+						if (!vars.count(var)) continue;
+						auto version = push(var, pushed);
+						if (analysis::insn::isAssignInsn(insn)) cast<AssignInsn>(insn)->setLhs(version);
+						else                                    cast<LoadInsn>(insn)->setTarget(version);
+					}
+				}
+
+				// fill in the operands of the phis this bb flows into
+				for (const auto& succ : analysis::controlflow::getSuccessors(fun, bb)) {
+					unsigned index = detail::getPredecessorIndex(fun, succ, bb);
+					for (const auto& phi : detail::getPhis(succ)) {
+						const auto& var = phi->getRhs()[index];
+						if (vars.count(var)) phi->setRhs(index, top(var));
+					}
+				}
+
+				for (const auto& child : dominators.getChildren(bb))
+					rename(child);
+				for (const auto& var : pushed)
+					stacks[var].pop_back();
+			}
+		private:
+			VariablePtr top(const VariablePtr& var) {
+				const auto& stack = stacks[var];
+				return stack.empty() ? var : stack.back();
+			}
+
+			VariablePtr push(const VariablePtr& var, VariableList& pushed) {
+				auto version = manager.buildVariable(var, ++counters[var]);
+				stacks[var].push_back(version);
+				pushed.push_back(var);
+				return version;
+			}
+		};
+
+		// liveness on bb level w.r.t. the semantics of phis: these are defined on top
+		// of their bb whereas their operands are read at the end of the respective pred
+		class PhiLiveness {
+			std::unordered_map<BasicBlockPtr, VariableSet> liveIn;
+			std::unordered_map<BasicBlockPtr, VariableSet> liveOut;
+		public:
+			PhiLiveness(const FunctionPtr& fun) {
+				const auto& bbs = fun->getBasicBlocks();
+				std::unordered_map<BasicBlockPtr, VariableSet> uses, defs, phiDefs, phiUses;
+				for (const auto& bb : bbs) {
+					for (const auto& insn : bb->getInsns()) {
+						if (isPhiInsn(insn)) {
+							auto phi = cast<PhiInsn>(insn);
+							phiDefs[bb].insert(phi->getLhs());
+							auto preds = analysis::controlflow::getPredecessors(fun, bb);
+							for (unsigned i = 0; i < preds.size(); ++i)
+								phiUses[preds[i]].insert(phi->getRhs()[i]);
+							continue;
+						}
+						for (const auto& var : analysis::insn::getInputVars(insn))
+							if (!defs[bb].count(var)) uses[bb].insert(var);
+						if (analysis::insn::isAllocaInsn(insn)) continue;
+						auto vo = analysis::insn::getOutputVars(insn);
+						defs[bb].insert(vo.begin(), vo.end());
+					}
+				}
+
+				bool changed = true;
+				while (changed) {
+					changed = false;
+					// visit in reverse as most bbs are listed before their successors
+					for (auto it = bbs.rbegin(); it != bbs.rend(); ++it) {
+						const auto& bb = *it;
+						VariableSet out(phiUses[bb]);
+						for (const auto& succ : analysis::controlflow::getSuccessors(fun, bb)) {
+							for (const auto& var : liveIn[succ])
+								if (!phiDefs[succ].count(var)) out.insert(var);
+						}
+						VariableSet in(uses[bb]);
+						in.insert(phiDefs[bb].begin(), phiDefs[bb].end());
+						for (const auto& var : out)
+							if (!defs[bb].count(var)) in.insert(var);
+
+						if (in.size() != liveIn[bb].size() || out.size() != liveOut[bb].size()) changed = true;
+						liveIn[bb] = std::move(in);
+						liveOut[bb] = std::move(out);
+					}
+				}
+			}
+
+			const VariableSet& getLiveIn(const BasicBlockPtr& bb) const { return liveIn.at(bb); }
+			const VariableSet& getLiveOut(const BasicBlockPtr& bb) const { return liveOut.at(bb); }
+		};
+
+		// only versions of the same var are candidates for coalescing, thus interferences
+		// among them are recorded solely. the set live after the phis of a bb is kept
+		Interference getInterference(const FunctionPtr& fun, const PhiLiveness& liveness,
+			std::unordered_map<BasicBlockPtr, VariableSet>& liveAfterPhis) {
+			Interference result;
+			auto interfere = [&](const VariablePtr& def, const VariableSet& live) {
+				for (const auto& var : live) {
+					if (*var == *def || var->getBaseName() != def->getBaseName()) continue;
+					result[def].insert(var);
+					result[var].insert(def);
+				}
+			};
+
+			for (const auto& bb : fun->getBasicBlocks()) {
+				VariableSet live(liveness.getLiveOut(bb));
+				VariableSet phiDefs;
+				for (auto it = bb->getInsns().rbegin(); it != bb->getInsns().rend(); ++it) {
+					const auto& insn = *it;
+					if (isPhiInsn(insn)) {
+						phiDefs.insert(cast<PhiInsn>(insn)->getLhs());
+						continue;
+					}
+					if (analysis::insn::isAllocaInsn(insn)) continue;
+					auto vo = analysis::insn::getOutputVars(insn);
+					for (const auto& var : vo) interfere(var, live);
+					for (const auto& var : vo) live.erase(var);
+					auto vi = analysis::insn::getInputVars(insn);
+					live.insert(vi.begin(), vi.end());
+				}
+				// all phis of a bb are defined simultaneously
+				for (const auto& var : phiDefs) {
+					interfere(var, live);
+					interfere(var, phiDefs);
+				}
+				liveAfterPhis[bb] = std::move(live);
+			}
+			return result;
+		}
+
+		// the copies of a parallel copy are ordered such that no source is overwritten
+		// before being read, cycles are broken by means of a temporary
+		InsnList sequentialize(NodeManager& manager, ParallelCopy copies) {
+			InsnList result;
+			while (!copies.empty()) {
+				auto ready = std::find_if(copies.begin(), copies.end(), [&](const ParallelCopy::value_type& copy) {
+					return std::none_of(copies.begin(), copies.end(),
+						[&](const ParallelCopy::value_type& other) { return *other.second == *copy.first; });
+				});
+				if (ready != copies.end()) {
+					result.push_back(manager.buildAssign(ready->first, ready->second));
+					copies.erase(ready);
+					continue;
+				}
+
+				auto target = copies.front().first;
+				auto tmp = manager.buildTemporary(target->getType());
+				result.push_back(manager.buildAssign(tmp, target));
+				for (auto& copy : copies)
+					if (*copy.second == *target) copy.second = tmp;
+			}
+			return result;
+		}
+
+		// the value of a version resp. a temporary is never changed after its def, which
+		// also holds for a var whose defs have all been renamed
+		bool isInvariant(const VariablePtr& var) {
+			if (var->hasSSAIndex()) return true;
+			const auto& defs = var->getDefs();
+			if (analysis::isTemporary(var)) return defs.size() == 1;
+			return std::all_of(defs.begin(), defs.end(),
+				[](const InsnPtr& insn) { return analysis::insn::isAllocaInsn(insn); });
+		}
+
+		// the versions of a var must not overlap, as they would enforce copies when
+		// leaving ssa form. thus a var is only propagated within the bb of the copy,
+		// up to its next assignment
+		bool isLocalCopy(const InsnPtr& copy, const VariablePtr& lhs, const VariablePtr& rhs) {
+			const auto& bb = copy->getParent();
+			InsnList uses(lhs->getUses());
+			for (const auto& use : uses)
+				if (use->getParent() != bb) return false;
+
+			const auto& insns = bb->getInsns();
+			for (auto it = std::next(BasicBlock::getPosition(copy)); it != insns.end() && !uses.empty(); ++it) {
+				uses.erase(std::remove(uses.begin(), uses.end(), *it), uses.end());
+				for (const auto& var : analysis::insn::getOutputVars(*it))
+					if (var->getBaseName() == rhs->getBaseName()) return uses.empty();
+			}
+			return uses.empty();
+		}
+
+		struct EdgeCopy {
+			BasicBlockPtr pred;
+			BasicBlockPtr succ;
+			InsnList copies;
+		};
+
+		// a value is undefined as long as none of its defs has been reached, it
+		// remains constant until two distinct values meet
+		struct Lattice {
+			enum Kind { LK_Undefined, LK_Constant, LK_Overdefined };
+			Kind kind;
+			ValuePtr value;
+
+			static Lattice meet(const Lattice& lhs, const Lattice& rhs) {
+				if (lhs.kind == LK_Undefined) return rhs;
+				if (rhs.kind == LK_Undefined) return lhs;
+				if (lhs.kind == LK_Constant && rhs.kind == LK_Constant && *lhs.value == *rhs.value) return lhs;
+				return { LK_Overdefined, nullptr };
+			}
+		};
+
+		bool isZero(const ValuePtr& value) {
+			return arithmetic::getValue<float>(value) == 0;
+		}
+
+		// only a var with a single def carries a value of its own, offsets and
+		// arrays denote addresses
+		bool isTracked(const VariablePtr& var) {
+			if (analysis::isOffset(var) || analysis::types::isArray(var->getType())) return false;
+			return var->hasSSAIndex() || (analysis::isTemporary(var) && var->getDefs().size() == 1);
+		}
+
+		// the insns whose operand may be a constant instead of var
+		bool isSubstitutable(const InsnPtr& insn, const VariablePtr& var) {
+			switch (insn->getInsnType()) {
+			case Insn::IT_Assign:
+			case Insn::IT_Push:
+			case Insn::IT_Return:
+			case Insn::IT_FalseJump:
+				return true;
+			case Insn::IT_Store:
+				return *cast<StoreInsn>(insn)->getTarget() != *var;
+			default:
+				return false;
+			}
+		}
+
+		void fold(NodeManager& manager, const AssignInsnPtr& assign) {
+			ValuePtr value;
+			if (assign->isUnary() && analysis::isConstant(assign->getRhs1()))
+				value = arithmetic::evaluate(manager, assign->getOp(), assign->getRhs1());
+			else if (assign->isBinary() && arithmetic::isEvaluable(assign->getRhs1(), assign->getRhs2()))
+				value = arithmetic::evaluate(manager, assign->getOp(), assign->getRhs1(), assign->getRhs2());
+			else
+				return;
+			assign->setRhs1(value);
+			assign->setRhs2(nullptr);
+			assign->setOp(AssignInsn::NONE);
+		}
+
+		// the work lists of wegman & zadeck: an edge which becomes executable reveals
+		// a bb resp. a phi operand, a var which is lowered revisits its uses
+		class ConstantPropagator {
+			NodeManager& manager;
+			const FunctionPtr& fun;
+			std::map<VariablePtr, Lattice, target_less<Variable>> values;
+			std::set<Edge> edges;
+			std::unordered_set<BasicBlockPtr> reached;
+			std::vector<Edge> flowList;
+			InsnList ssaList;
+		public:
+			ConstantPropagator(NodeManager& manager, const FunctionPtr& fun) :
+				manager(manager), fun(fun) {}
+
+			void propagate(const BasicBlockPtr& entry) {
+				flowList.push_back(std::make_pair(nullptr, entry));
+				while (!flowList.empty() || !ssaList.empty()) {
+					if (ssaList.empty()) {
+						auto bb = flowList.back().second;
+						flowList.pop_back();
+						if (!reached.insert(bb).second) {
+							for (const auto& phi : detail::getPhis(bb)) visit(phi);
+							continue;
+						}
+						for (const auto& insn : bb->getInsns()) visit(insn);
+						// apart from a false jump, a bb is left unconditionally
+						const auto& insns = bb->getInsns();
+						if (insns.empty() || !analysis::insn::isFalseJumpInsn(insns.back())) {
+							for (const auto& succ : analysis::controlflow::getSuccessors(fun, bb))
+								markEdge(bb, succ);
 						}
+						continue;
+					}
 
-						if (found) {
-							VariableList rhs;
-							for (unsigned i = 0; i < analysis::controlflow::getPredecessors(fun, bb).size(); ++i)
-								rhs.push_back(var);
+					auto insn = ssaList.back();
+					ssaList.pop_back();
+					if (reached.count(insn->getParent())) visit(insn);
+				}
+			}
+
+			bool isReached(const BasicBlockPtr& bb) const { return reached.count(bb) > 0; }
+			bool isExecutable(const BasicBlockPtr& pred, const BasicBlockPtr& succ) const {
+				return edges.count(std::make_pair(pred, succ)) > 0;
+			}
+
+			Lattice getLattice(const ValuePtr& value) const {
+				if (analysis::isIntConstant(value) || analysis::isFloatConstant(value))
+					return { Lattice::LK_Constant, value };
+				auto var = dyn_cast<Variable>(value);
+				if (!var || !isTracked(var)) return { Lattice::LK_Overdefined, nullptr };
+				auto it = values.find(var);
+				return it != values.end() ? it->second : Lattice{ Lattice::LK_Undefined, nullptr };
+			}
+
+			std::map<VariablePtr, ValuePtr, target_less<Variable>> getConstants() const {
+				std::map<VariablePtr, ValuePtr, target_less<Variable>> result;
+				for (const auto& pair : values)
+					if (pair.second.kind == Lattice::LK_Constant) result[pair.first] = pair.second.value;
+				return result;
+			}
+		private:
+			void markEdge(const BasicBlockPtr& pred, const BasicBlockPtr& succ) {
+				auto edge = std::make_pair(pred, succ);
+				if (edges.insert(edge).second) flowList.push_back(edge);
+			}
+
+			void update(const VariablePtr& var, const Lattice& lattice) {
+				if (!isTracked(var)) return;
+				auto it = values.insert(std::make_pair(var, Lattice{ Lattice::LK_Undefined, nullptr })).first;
+				// values are only ever lowered, thus a change is one of the kind
+				auto result = Lattice::meet(it->second, lattice);
+				if (result.kind == it->second.kind) return;
+				it->second = result;
+				ssaList.insert(ssaList.end(), var->getUses().begin(), var->getUses().end());
+			}
+
+			Lattice evaluate(const AssignInsnPtr& assign) const {
+				auto rhs1 = getLattice(assign->getRhs1());
+				if (assign->isAssign()) return rhs1;
+				auto rhs2 = assign->isBinary() ? getLattice(assign->getRhs2()) : rhs1;
+				if (rhs1.kind == Lattice::LK_Overdefined || rhs2.kind == Lattice::LK_Overdefined)
+					return { Lattice::LK_Overdefined, nullptr };
+				if (rhs1.kind == Lattice::LK_Undefined || rhs2.kind == Lattice::LK_Undefined)
+					return { Lattice::LK_Undefined, nullptr };
+
+				if (assign->isUnary())
+					return { Lattice::LK_Constant, arithmetic::evaluate(manager, assign->getOp(), rhs1.value) };
+				// a division by zero is left to the runtime
+				if (!arithmetic::isEvaluable(rhs1.value, rhs2.value) ||
+					(assign->getOp() == AssignInsn::DIV && isZero(rhs2.value)))
+					return { Lattice::LK_Overdefined, nullptr };
+				return { Lattice::LK_Constant, arithmetic::evaluate(manager, assign->getOp(), rhs1.value, rhs2.value) };
+			}
 
-								BasicBlock::prepend(bb, manager.buildPhi(var, rhs));
+			void visit(const InsnPtr& insn) {
+				const auto& bb = insn->getParent();
+				switch (insn->getInsnType()) {
+				case Insn::IT_Phi:
+					{
+						auto phi = cast<PhiInsn>(insn);
+						auto preds = analysis::controlflow::getPredecessors(fun, bb);
+						Lattice result{ Lattice::LK_Undefined, nullptr };
+						// operands of edges which are not executable (yet) are ignored
+						for (unsigned i = 0; i < preds.size(); ++i)
+							if (isExecutable(preds[i], bb)) result = Lattice::meet(result, getLattice(phi->getRhs()[i]));
+						update(phi->getLhs(), result);
+					}
+					break;
+				case Insn::IT_Assign:
+					{
+						auto assign = cast<AssignInsn>(insn);
+						update(assign->getLhs(), evaluate(assign));
+					}
+					break;
+				case Insn::IT_FalseJump:
+					{
+						auto jump = cast<FalseJumpInsn>(insn);
+						auto cond = getLattice(jump->getCond());
+						if (cond.kind == Lattice::LK_Undefined) break;
+						auto succs = analysis::controlflow::getSuccessors(fun, bb);
+						for (const auto& succ : succs) {
+							bool target = *succ->getLabel() == *jump->getTarget();
+							if (cond.kind == Lattice::LK_Overdefined || succs.size() == 1 || target == isZero(cond.value))
+								markEdge(bb, succ);
 						}
+					}
+					break;
+				default:
+					// e.g. loads & calls, their results are not known
+					for (const auto& var : analysis::insn::getOutputVars(insn))
+						update(var, { Lattice::LK_Overdefined, nullptr });
+					break;
+				}
+			}
+		};
 
-						hasAlready.insert(bb);
-						workList.insert(bb);
+		// the phis of the bbs which are left lose the operands of removed edges, a
+		// single operand left turns a phi into a copy
+		void removeBasicBlocks(NodeManager& manager, const FunctionPtr& fun,
+			const std::vector<Edge>& edges, const BasicBlockList& bbs) {
+			// the phi operands are associated with the preds before any edge is removed
+			std::vector<std::pair<BasicBlockPtr, BasicBlockList>> joins;
+			for (const auto& bb : fun->getBasicBlocks()) {
+				if (std::find(bbs.begin(), bbs.end(), bb) != bbs.end() || detail::getPhis(bb).empty()) continue;
+				joins.push_back(std::make_pair(bb, analysis::controlflow::getPredecessors(fun, bb)));
+			}
+
+			auto& graph = fun->getGraph();
+			for (const auto& edge : edges)
+				graph.removeEdge(edge.first, edge.second);
+			for (const auto& bb : bbs) {
+				// the insns are unlinked, thus they do not remain uses & defs of their vars
+				while (!bb->getInsns().empty())
+					BasicBlock::remove(bb, bb->getInsns().begin());
+				graph.removeVertex(bb);
+			}
+
+			for (const auto& join : joins) {
+				const auto& bb = join.first;
+				const auto& before = join.second;
+				auto preds = analysis::controlflow::getPredecessors(fun, bb);
+				if (preds.size() == before.size()) continue;
+				for (const auto& phi : detail::getPhis(bb)) {
+					VariableList rhs;
+					for (const auto& pred : preds) {
+						auto it = std::find_if(before.begin(), before.end(),
+							[&](const BasicBlockPtr& cur) { return *cur == *pred; });
+						assert(it != before.end() && "a phi lacks the operand of a new edge");
+						rhs.push_back(phi->getRhs()[it - before.begin()]);
 					}
+					InsnPtr insn;
+					if (rhs.size() == 1) insn = manager.buildAssign(phi->getLhs(), rhs.front());
+					else                 insn = manager.buildPhi(phi->getLhs(), rhs);
+					auto pos = BasicBlock::getPosition(phi);
+					BasicBlock::insert(bb, pos, insn);
+					BasicBlock::remove(bb, pos);
+				}
+			}
+		}
+
+		// insns with an effect beyond the values they define
+		bool isCritical(const InsnPtr& insn) {
+			switch (insn->getInsnType()) {
+			case Insn::IT_Return:
+			case Insn::IT_Call:
+			case Insn::IT_Store:
+			case Insn::IT_Push:
+			case Insn::IT_Pop:
+			case Insn::IT_PushSp:
+			case Insn::IT_PopSp:
+				return true;
+			default:
+				return false;
+			}
+		}
+	}
+
+	void SSAEncoderPass::apply(const FunctionPtr& fun) {
+		if (fun->getGraph().empty()) return;
+
+		VariableSet vars;
+		for (const auto& var : analysis::controlflow::getAllVars(fun))
+			if (isRenamable(var)) vars.insert(var);
+		if (vars.empty()) return;
+
+		// compute which bbs have an assignment to vars first
+		std::unordered_map<BasicBlockPtr, VariableSet> modifiedVars;
+		for (const auto& bb : fun->getBasicBlocks())
+			modifiedVars.insert(std::make_pair(bb, analysis::controlflow::getModifiedVars(bb)));
+
+		// compute the dominator tree, it also provides the frontier of each bb
+		auto dominators = analysis::controlflow::getDominatorTree(fun);
+
+		// a phi is only placed where its var is live (pruned form)
+		PhiLiveness liveness(fun);
+		for (const auto& var : vars) {
+			// the bbs containing an assignment to var are the initial work list
+			BasicBlockList workList;
+			analysis::controlflow::DominatorSet defs;
+			for (const auto& bb : fun->getBasicBlocks()) {
+				if (!modifiedVars[bb].count(var)) continue;
+				workList.push_back(bb);
+				defs.insert(bb);
+			}
+
+			// the iterated frontier of all defs receives a phi
+			analysis::controlflow::DominatorSet hasAlready;
+			while (!workList.empty()) {
+				auto cur = workList.back();
+				workList.pop_back();
+
+				for (const auto& bb : dominators.getFrontier(cur)) {
+					if (!hasAlready.insert(bb).second) continue;
+					if (!liveness.getLiveIn(bb).count(var)) continue;
+
+					VariableList rhs(analysis::controlflow::getPredecessors(fun, bb).size(), var);
+					BasicBlock::prepend(bb, manager.buildPhi(var, rhs));
+					// the phi is a new def of var
+					if (!defs.count(bb)) workList.push_back(bb);
 				}
 			}
 		}
+
+		Renamer renamer(manager, fun, dominators, vars);
+		renamer.rename(dominators.getRoot());
 	}
 
 	void SSAEncoderPass::apply() {
@@ -86,8 +618,366 @@ namespace passes {
 			apply(fun);
 	}
 
+	void SparseConditionalConstantPropagationPass::apply(const FunctionPtr& fun) {
+		if (fun->getGraph().empty()) return;
+		ConstantPropagator propagator(manager, fun);
+		propagator.propagate(analysis::controlflow::getEntryPoint(fun));
+
+		// a false jump on a constant either always or never jumps
+		for (const auto& bb : fun->getBasicBlocks()) {
+			if (!propagator.isReached(bb) || bb->getInsns().empty()) continue;
+			auto insn = bb->getInsns().back();
+			if (!analysis::insn::isFalseJumpInsn(insn)) continue;
+			auto jump = cast<FalseJumpInsn>(insn);
+			auto cond = propagator.getLattice(jump->getCond());
+			if (cond.kind != Lattice::LK_Constant) continue;
+			auto pos = BasicBlock::getPosition(insn);
+			if (isZero(cond.value)) BasicBlock::insert(bb, pos, manager.buildGoto(jump->getTarget()));
+			BasicBlock::remove(bb, pos);
+		}
+
+		BasicBlockList unreached;
+		std::vector<Edge> edges;
+		for (const auto& bb : fun->getBasicBlocks()) {
+			if (!propagator.isReached(bb)) {
+				unreached.push_back(bb);
+				continue;
+			}
+			for (const auto& succ : analysis::controlflow::getSuccessors(fun, bb))
+				if (!propagator.isExecutable(bb, succ)) edges.push_back(std::make_pair(bb, succ));
+		}
+		removeBasicBlocks(manager, fun, edges, unreached);
+
+		// uses of a constant are replaced, its def only remains for the phis reading it
+		for (const auto& pair : propagator.getConstants()) {
+			const auto& var = pair.first;
+			const auto& value = pair.second;
+			InsnList uses(var->getUses());
+			for (const auto& insn : uses) {
+				if (!isSubstitutable(insn, var)) continue;
+				insn->replaceNode(var, value);
+				if (analysis::insn::isAssignInsn(insn)) fold(manager, cast<AssignInsn>(insn));
+			}
+
+			InsnList defs(var->getDefs());
+			for (const auto& insn : defs) {
+				if (var->getUses().empty()) {
+					BasicBlock::remove(insn->getParent(), BasicBlock::getPosition(insn));
+				} else if (analysis::insn::isAssignInsn(insn)) {
+					auto assign = cast<AssignInsn>(insn);
+					assign->setRhs1(value);
+					assign->setRhs2(nullptr);
+					assign->setOp(AssignInsn::NONE);
+				}
+			}
+		}
+
+		detail::anchorBasicBlocks(fun);
+	}
+
+	void SparseConditionalConstantPropagationPass::apply() {
+		for (const auto& fun : manager.getProgram()->getFunctions())
+			apply(fun);
+	}
+
+	void CopyPropagationPass::apply(const FunctionPtr& fun) {
+		InsnList copies;
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (const auto& insn : bb->getInsns()) {
+				if (!analysis::insn::isAssignInsn(insn)) continue;
+				auto assign = cast<AssignInsn>(insn);
+				if (assign->isAssign() && assign->getLhs()->hasSSAIndex()) copies.push_back(insn);
+			}
+		}
+
+		for (const auto& insn : copies) {
+			auto assign = cast<AssignInsn>(insn);
+			auto lhs = assign->getLhs();
+			auto rhs = dyn_cast<Variable>(assign->getRhs1());
+			if (!rhs || analysis::isOffset(rhs)) continue;
+			if (!isInvariant(rhs)) continue;
+
+			// a phi operand of another var enforces a copy anyway, which would then
+			// overlap with the source
+			const auto& uses = lhs->getUses();
+			if (std::any_of(uses.begin(), uses.end(), isPhiInsn)) continue;
+			if (analysis::isMemory(rhs) && !isLocalCopy(insn, lhs, rhs)) continue;
+			replaceAllUsesWith(lhs, rhs);
+			BasicBlock::remove(insn->getParent(), BasicBlock::getPosition(insn));
+		}
+	}
+
+	void CopyPropagationPass::apply() {
+		for (const auto& fun : manager.getProgram()->getFunctions())
+			apply(fun);
+	}
+
+	void AggressiveDeadCodeEliminationPass::apply(const FunctionPtr& fun) {
+		if (fun->getGraph().empty()) return;
+		auto postDominators = analysis::controlflow::getPostDominatorTree(fun);
+		const auto& exit = postDominators.getRoot();
+
+		std::unordered_set<InsnPtr> marked;
+		InsnList workList;
+		auto mark = [&](const InsnPtr& insn) {
+			if (marked.insert(insn).second) workList.push_back(insn);
+		};
+		// the branches deciding whether bb is executed
+		auto markControlDependences = [&](const BasicBlockPtr& bb) {
+			for (const auto& cd : postDominators.getFrontier(bb)) {
+				assert(analysis::insn::isFalseJumpInsn(cd->getInsns().back()) && "a branch ends in a false jump");
+				mark(cd->getInsns().back());
+			}
+		};
+
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (const auto& insn : bb->getInsns()) {
+				// allocas reserve the slots, thus they are kept anyway
+				if (isCritical(insn) || analysis::insn::isAllocaInsn(insn)) mark(insn);
+			}
+			// without a post dominator apart from the exit, there is nothing to jump to
+			const auto& insns = bb->getInsns();
+			if (insns.empty() || !analysis::insn::isFalseJumpInsn(insns.back())) continue;
+			auto ipdom = postDominators.getImmediateDominator(bb);
+			if (!ipdom || **ipdom == *exit) mark(insns.back());
+		}
+
+		while (!workList.empty()) {
+			auto insn = workList.back();
+			workList.pop_back();
+			// an alloca is placed at the declaration, which does not make its bb useful
+			if (!analysis::insn::isAllocaInsn(insn)) markControlDependences(insn->getParent());
+			// a phi further depends on the edge its value flows along
+			if (isPhiInsn(insn)) {
+				for (const auto& pred : analysis::controlflow::getPredecessors(fun, insn->getParent()))
+					markControlDependences(pred);
+			}
+			for (const auto& var : analysis::insn::getInputVars(insn)) {
+				for (const auto& def : var->getDefs()) mark(def);
+			}
+		}
+
+		// gotos are kept, these merely shape the graph
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (auto it = bb->getInsns().begin(); it != bb->getInsns().end();) {
+				const auto& insn = *it;
+				if (marked.count(insn) || analysis::insn::isGotoInsn(insn) ||
+					analysis::insn::isFalseJumpInsn(insn)) ++it;
+				else it = BasicBlock::remove(bb, it);
+			}
+		}
+
+		// a dead branch jumps to its immediate post dominator, the bbs in between are skipped
+		auto& graph = fun->getGraph();
+		std::vector<Edge> edges;
+		for (const auto& bb : fun->getBasicBlocks()) {
+			const auto& insns = bb->getInsns();
+			if (insns.empty() || marked.count(insns.back()) || !analysis::insn::isFalseJumpInsn(insns.back())) continue;
+			auto ipdom = *postDominators.getImmediateDominator(bb);
+			auto pos = std::prev(insns.end());
+			BasicBlock::insert(bb, pos, manager.buildGoto(ipdom->getLabel()));
+			BasicBlock::remove(bb, pos);
+			for (const auto& succ : analysis::controlflow::getSuccessors(fun, bb))
+				if (*succ != *ipdom) edges.push_back(std::make_pair(bb, succ));
+			// a live phi in ipdom implies a live branch, hence bb is a pred already
+			if (!graph.hasEdge(bb, ipdom)) graph.addEdge(bb, ipdom);
+		}
+		if (edges.empty()) return;
+		removeBasicBlocks(manager, fun, edges, {});
+
+		BasicBlockList unreachable;
+		auto dominators = analysis::controlflow::getDominatorTree(fun);
+		for (const auto& bb : fun->getBasicBlocks())
+			if (!dominators.isReachable(bb)) unreachable.push_back(bb);
+		removeBasicBlocks(manager, fun, {}, unreachable);
+		detail::anchorBasicBlocks(fun);
+	}
+
+	void AggressiveDeadCodeEliminationPass::apply() {
+		for (const auto& fun : manager.getProgram()->getFunctions())
+			apply(fun);
+	}
+
+	void SSADecoderPass::apply(const FunctionPtr& fun) {
+		std::vector<std::pair<BasicBlockPtr, std::vector<PhiInsnPtr>>> joins;
+		for (const auto& bb : fun->getBasicBlocks()) {
+			auto phis = detail::getPhis(bb);
+			if (!phis.empty()) joins.push_back(std::make_pair(bb, phis));
+		}
+
+		PhiLiveness liveness(fun);
+		std::unordered_map<BasicBlockPtr, VariableSet> liveAfterPhis;
+		auto interference = getInterference(fun, liveness, liveAfterPhis);
+
+		// coalesce the operands of each phi with its lhs unless their classes interfere
+		std::map<VariablePtr, VariableList, target_less<Variable>> classes;
+		std::map<VariablePtr, VariablePtr, target_less<Variable>> leaders;
+		auto find = [&](const VariablePtr& var) {
+			auto it = leaders.find(var);
+			if (it != leaders.end()) return it->second;
+			leaders[var] = var;
+			classes[var] = { var };
+			return var;
+		};
+		auto interferes = [&](const VariableList& lhs, const VariableList& rhs) {
+			for (const auto& var : lhs) {
+				auto it = interference.find(var);
+				if (it == interference.end()) continue;
+				for (const auto& other : rhs)
+					if (it->second.count(other)) return true;
+			}
+			return false;
+		};
+		for (const auto& join : joins) {
+			for (const auto& phi : join.second) {
+				for (const auto& var : phi->getRhs()) {
+					if (var->getBaseName() != phi->getLhs()->getBaseName()) continue;
+					auto lhs = find(phi->getLhs());
+					auto rhs = find(var);
+					if (*lhs == *rhs || interferes(classes[lhs], classes[rhs])) continue;
+					for (const auto& member : classes[rhs]) {
+						leaders[member] = lhs;
+						classes[lhs].push_back(member);
+					}
+					classes.erase(rhs);
+				}
+			}
+		}
+
+		// versions apart from phis form classes on their own
+		for (const auto& var : analysis::controlflow::getAllVars(fun))
+			if (var->hasSSAIndex()) find(var);
+
+		// a class is named after the var itself if it takes part, otherwise the most
+		// referenced class of a var receives its name unless the var is still in use
+		auto getNumOfRefs = [&](const VariablePtr& leader) {
+			size_t result = 0;
+			for (const auto& var : classes[leader]) result += var->getUses().size() + var->getDefs().size();
+			return result;
+		};
+		std::map<VariablePtr, VariablePtr, target_less<Variable>> names;
+		std::map<std::string, VariableList> unnamed;
+		for (const auto& pair : classes) {
+			const auto& members = pair.second;
+			auto it = std::find_if(members.begin(), members.end(),
+				[](const VariablePtr& var) { return !var->hasSSAIndex(); });
+			if (it != members.end()) {
+				names[pair.first] = *it;
+				continue;
+			}
+			names[pair.first] = pair.first;
+			unnamed[pair.first->getBaseName()].push_back(pair.first);
+		}
+		for (const auto& pair : unnamed) {
+			const auto& version = pair.second.front();
+			if (!analysis::isMemory(version)) continue;
+			auto var = manager.buildVariable(version->getType(), version->getBaseName());
+			if (leaders.count(var) || !var->getUses().empty()) continue;
+			bool reserved = std::all_of(var->getDefs().begin(), var->getDefs().end(),
+				[](const InsnPtr& insn) { return analysis::insn::isAllocaInsn(insn); });
+			if (!reserved) continue;
+
+			auto largest = std::max_element(pair.second.begin(), pair.second.end(),
+				[&](const VariablePtr& lhs, const VariablePtr& rhs) { return getNumOfRefs(lhs) < getNumOfRefs(rhs); });
+			names[*largest] = var;
+		}
+		auto getName = [&](const VariablePtr& var) {
+			auto it = names.find(find(var));
+			return it != names.end() ? it->second : var;
+		};
+
+		// the copies of each incoming edge form a parallel copy, dead phis are skipped
+		std::vector<EdgeCopy> edges;
+		for (const auto& join : joins) {
+			const auto& bb = join.first;
+			const auto& live = liveAfterPhis[bb];
+			auto preds = analysis::controlflow::getPredecessors(fun, bb);
+			for (unsigned i = 0; i < preds.size(); ++i) {
+				ParallelCopy copies;
+				for (const auto& phi : join.second) {
+					if (!live.count(phi->getLhs())) continue;
+					auto lhs = getName(phi->getLhs());
+					auto rhs = getName(phi->getRhs()[i]);
+					if (*lhs != *rhs) copies.push_back(std::make_pair(lhs, rhs));
+				}
+				if (!copies.empty()) edges.push_back({ preds[i], bb, sequentialize(manager, copies) });
+			}
+		}
+
+		for (const auto& join : joins) {
+			for (const auto& phi : join.second)
+				BasicBlock::remove(join.first, BasicBlock::getPosition(phi));
+		}
+
+		// now the remaining references are renamed
+		for (const auto& pair : leaders) {
+			const auto& var = pair.first;
+			auto name = getName(var);
+			if (*var == *name) continue;
+			InsnList defs(var->getDefs());
+			for (const auto& insn : defs) {
+				if (analysis::insn::isAssignInsn(insn)) cast<AssignInsn>(insn)->setLhs(name);
+				else                                    cast<LoadInsn>(insn)->setTarget(name);
+			}
+			replaceAllUsesWith(var, name);
+		}
+
+		// the layout falls through into a bb or follows a false jump, a bb which is
+		// solely entered by gotos otherwise has to be reached through a split edge
+		std::unordered_map<BasicBlockPtr, bool> anchored;
+		auto isSplit = [&](const BasicBlockPtr& pred, const BasicBlockPtr& succ) {
+			return analysis::controlflow::getSuccessors(fun, pred).size() > 1 &&
+				std::any_of(edges.begin(), edges.end(), [&](const EdgeCopy& edge) {
+					return *edge.pred == *pred && *edge.succ == *succ;
+				});
+		};
+		for (const auto& join : joins) {
+			const auto& bb = join.first;
+			bool result = false;
+			for (const auto& pred : analysis::controlflow::getPredecessors(fun, bb)) {
+				const auto& insns = pred->getInsns();
+				bool jump = !insns.empty() && detail::isJumpTo(insns.back(), bb);
+				if (isSplit(pred, bb)) result |= !jump;
+				else result |= insns.empty() || !analysis::insn::isGotoInsn(insns.back());
+			}
+			anchored[bb] = result;
+		}
+
+		auto& graph = fun->getGraph();
+		for (const auto& edge : edges) {
+			const auto& pred = edge.pred;
+			const auto& succ = edge.succ;
+			const auto& insns = pred->getInsns();
+			if (analysis::controlflow::getSuccessors(fun, pred).size() == 1) {
+				// the copies are placed right in front of the terminating jump
+				auto pos = insns.end();
+				if (!insns.empty() && analysis::insn::getJumpTarget(insns.back())) --pos;
+				for (const auto& copy : edge.copies)
+					BasicBlock::insert(pred, pos, copy);
+				continue;
+			}
+
+			// critical edge, a new bb is placed in between
+			auto bb = manager.buildBasicBlock();
+			bb->setLabel(manager.buildLabel());
+			bb->setParent(fun);
+			for (const auto& copy : edge.copies)
+				BasicBlock::append(bb, copy);
+			if (detail::isJumpTo(insns.back(), succ)) {
+				insns.back()->replaceNode(succ->getLabel(), bb->getLabel());
+				if (anchored[succ]) BasicBlock::append(bb, manager.buildGoto(succ->getLabel()));
+				anchored[succ] = true;
+			}
+			graph.addVertex(bb);
+			graph.removeEdge(pred, succ);
+			graph.addEdge(pred, bb);
+			graph.addEdge(bb, succ);
+		}
+	}
+
 	void SSADecoderPass::apply() {
-		/* no-op */
+		for (const auto& fun : manager.getProgram()->getFunctions())
+			apply(fun);
 	}
 }
 }
@@ -5,17 +5,72 @@
 namespace core {
 namespace passes {
 
+	// scalar memory vars are renamed into versions along the dominator tree,
+	// phis are only placed at join points where their var is live
 	class SSAEncoderPass : public Pass {
+	public:
+		SSAEncoderPass(NodeManager& manager) :
+			Pass(manager) {}
+		void apply() override;
+	private:
 		void apply(const FunctionPtr& fun);
+	};
+
+	// values are propagated along the def-use chains of the ssa form, yet only
+	// across edges which may be taken. branches on constants are folded and the
+	// bbs which are not reached anymore are removed
+	class SparseConditionalConstantPropagationPass : public Pass {
 	public:
-		using Pass::Pass;
+		SparseConditionalConstantPropagationPass(NodeManager& manager) :
+			Pass(manager) {}
 		void apply() override;
+	private:
+		void apply(const FunctionPtr& fun);
 	};
 
+	// uses of a version which is a mere copy are redirected to its source, the
+	// copy vanishes unless the version is still read by a phi
+	class CopyPropagationPass : public Pass {
+	public:
+		CopyPropagationPass(NodeManager& manager) :
+			Pass(manager) {}
+		void apply() override;
+	private:
+		void apply(const FunctionPtr& fun);
+	};
+
+	// only insns which contribute to a return, call or store are kept. a branch is kept
+	// as long as a kept insn is control dependent on it, otherwise the bb jumps straight
+	// to its immediate post dominator
+	class AggressiveDeadCodeEliminationPass : public Pass {
+	public:
+		AggressiveDeadCodeEliminationPass(NodeManager& manager) :
+			Pass(manager) {}
+		void apply() override;
+	private:
+		void apply(const FunctionPtr& fun);
+	};
+
+	// phis are turned into parallel copies placed on the incoming edges, critical
+	// ones are split. versions which do not interfere are coalesced beforehand
 	class SSADecoderPass : public Pass {
 	public:
-		using Pass::Pass;
+		SSADecoderPass(NodeManager& manager) :
+			Pass(manager) {}
 		void apply() override;
+	private:
+		void apply(const FunctionPtr& fun);
 	};
+
+	// helpers on the ssa form, the loop passes rely on these as well
+	namespace detail {
+		// the phis on top of bb
+		std::vector<PhiInsnPtr> getPhis(const BasicBlockPtr& bb);
+		// the position of pred among the preds of bb, thus of its operand in a phi
+		unsigned getPredecessorIndex(const FunctionPtr& fun, const BasicBlockPtr& bb, const BasicBlockPtr& pred);
+		bool isJumpTo(const InsnPtr& insn, const BasicBlockPtr& bb);
+		// a bb solely entered by gotos is placed right behind the pred of one of them
+		void anchorBasicBlocks(const FunctionPtr& fun);
+	}
 }
 }
@@ -18,6 +18,14 @@ namespace passes {
 		passes.push_back(makePass<NormalizeAssignmentsPass>(manager));
 		// do not swap with previous ones, as it would introduce errors to the code
 		passes.push_back(makePass<SuperLocalValueNumberingPass>(manager));
+		// global optimizations operate in between on the ssa form
+		passes.push_back(makePass<SSAEncoderPass>(manager));
+		passes.push_back(makePass<SparseConditionalConstantPropagationPass>(manager));
+		passes.push_back(makePass<CopyPropagationPass>(manager));
+		passes.push_back(makePass<AggressiveDeadCodeEliminationPass>(manager));
+		passes.push_back(makePass<LoopInvariantCodeMotionPass>(manager, loopAnalysis));
+		passes.push_back(makePass<InductionVariableStrengthReductionPass>(manager));
+		passes.push_back(makePass<SSADecoderPass>(manager));
 		passes.push_back(makePass<IntegrityPass>(manager));
 		return makePass<PassSequence>(manager, passes);
 	}
@@ -448,7 +448,7 @@ namespace frontend {
 
 	void Converter::buildBasicBlocks(const FunctionPtr& fun) {
 
-		auto& basicBlocks = fun->getBasicBlocks();
+		BasicBlockList basicBlocks;
 
 		basicBlocks.push_back(std::make_shared<BasicBlock>());
 
@@ -479,6 +479,8 @@ namespace frontend {
 				auto lbl = manager.buildLabel();
 				bb->setLabel(lbl);
 			}
+			// vertices are indexed by their label, so add them once it is fixed
+			fun->getGraph().addVertex(bb);
 		}
 
 		for(auto it = basicBlocks.begin(); it != basicBlocks.end(); ++it) {
@@ -52,7 +52,7 @@ function integration_test()
 	rm -f $output_file_gcc
 }
 
-for backend in "simple" "regalloc"
+for backend in "simple" "regalloc" "linearscan"
 do
 	printf "\n\033[0;33mexecuting integration tests using backend: $backend\033[0m\n"
 	for file in "$BASE/tests/snippets"/*.mC
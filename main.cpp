@@ -21,7 +21,7 @@ extern "C" {
 
 namespace {
 	struct arguments {
-		enum backend { simple, regalloc, standard };
+		enum backend { simple, regalloc, linearscan, standard };
 
 		arguments() :
 			optimize(true), unitTests(true), compile(true), instrument(false),
@@ -59,6 +59,7 @@ namespace {
 				{"instrument-max-recursion", no_argument, 0, 11},
 				{"profile", required_argument, 0, 12},
 				{"loop-analysis", no_argument, 0, 13},
+				{"backend-linearscan", no_argument, 0, 14},
 				{0, 0, 0, 0}
 			};
 			if (argc < 2) return false;
@@ -82,6 +83,7 @@ namespace {
 				case 11:	args.instrumentMaxRecursion = std::atoi(argv[optind-1]); break;
 				case 12:  args.profileFile = std::string(argv[optind-1]); break;
 				case 13:  args.loopAnalysis = true; break;
+				case 14:  args.backendType = arguments::backend::linearscan; break;
 				default:	break;
 				}
 			}
@@ -103,6 +105,7 @@ namespace {
 			std::cout << " [--libs             library path    ]" << std::endl;
 			std::cout << " [--backend-simple                   ]" << std::endl;
 			std::cout << " [--backend-regalloc                 ]" << std::endl;
+			std::cout << " [--backend-linearscan               ]" << std::endl;
 			std::cout << " [--instrument                       ]" << std::endl;
 			std::cout << " [--instrument-max-points            ]" << std::endl;
 			std::cout << " [--instrument-max-recursion         ]" << std::endl;
@@ -196,13 +199,16 @@ int main(int argc, char** argv) {
 	backend::BackendPtr backend;
 	switch (args.backendType) {
 	case arguments::backend::standard:
-			backend = backend::makeDefaultBackend(manager.getProgram());
+			backend = backend::makeDefaultBackend(manager);
 			break;
 	case arguments::backend::simple:
-			backend = backend::makeSimpleBackend(manager.getProgram());
+			backend = backend::makeSimpleBackend(manager);
 			break;
 	case arguments::backend::regalloc:
-			backend = backend::makeRegAllocBackend(manager.getProgram());
+			backend = backend::makeRegAllocBackend(manager);
+			break;
+	case arguments::backend::linearscan:
+			backend = backend::makeLinearScanBackend(manager);
 			break;
 	}
 	assert(backend && "no backend selected for ir conversion");
@@ -3,6 +3,7 @@
 #include <sstream>
 #include <map>
 #include <algorithm>
+#include <pthread.h>
 
 #include "core/core.h"
 #include "core/analysis/analysis-types.h"
@@ -10,16 +11,23 @@
 #include "core/analysis/analysis-callgraph.h"
 #include "core/analysis/analysis-insn.h"
 #include "core/analysis/analysis-live-variable.h"
+#include "core/analysis/analysis-reaching-definitions.h"
+#include "core/analysis/analysis-available-expressions.h"
 #include "core/analysis/analysis-interference-graph.h"
+#include "core/analysis/analysis-live-intervals.h"
 #include "core/analysis/analysis-loop.h"
+#include "core/analysis/analysis-numbering.h"
 #include "core/arithmetic/arithmetic.h"
 #include "core/passes/passes.h"
 #include "frontend/parser.h"
 #include "frontend/converter.h"
 #include "backend/backend-memory.h"
 #include "backend/backend-insn.h"
+#include "backend/backend-linearscan.h"
+#include "backend/backend-split.h"
 #include "stream_utils.h"
 #include "utils/utils-graph-color.h"
+#include "utils/utils-timex.h"
 #include "utils/utils-test.h"
 
 using namespace core;
@@ -176,8 +184,8 @@ namespace {
 		auto bb = fun->getBasicBlocks().front();
 
 		EXPECT(bb->getInsns().size() == 3);
-		auto fst = dyn_cast<AssignInsn>(bb->getInsns()[1]);
-		auto snd = dyn_cast<AssignInsn>(bb->getInsns()[2]);
+		auto fst = dyn_cast<AssignInsn>(*std::next(bb->getInsns().begin(), 1));
+		auto snd = dyn_cast<AssignInsn>(*std::next(bb->getInsns().begin(), 2));
 		EXPECT(fst && snd);
 		EXPECT(*(fst->getLhs()) == *(snd->getLhs()));
 		EXPECT(fst->getLhs() == snd->getLhs());
@@ -250,7 +258,7 @@ namespace {
 		auto vars = analysis::controlflow::getIncomingVars(bbs[1]);
 		EXPECT(vars.size() == 1);
 
-		auto varA = cast<AssignInsn>(bbs[0]->getInsns()[1])->getLhs();
+		auto varA = cast<AssignInsn>(*std::next(bbs[0]->getInsns().begin(), 1))->getLhs();
 		EXPECT(*varA == **vars.begin());
 	}
 
@@ -282,6 +290,76 @@ namespace {
 		EXPECT(*analysis::controlflow::getImmediateDominator(domMap, bbs[3]) == bbs[0]);
 	}
 
+	TEST(Analysis, DominatorTree)
+	{
+		string str_compound{R"({ int a = 0; while (a < 10) { if (a > 5) a = a + 2; else a = a + 1; } int b = a; })"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_compound);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto tree = analysis::controlflow::getDominatorTree(fun);
+		auto bbs = fun->getBasicBlocks();
+		EXPECT(bbs.size() == 7);
+
+		// L0 -> L1 -> {L2, L5}, L5 -> {L6, L3} -> L4 -> L1
+		EXPECT(tree.getRoot() == bbs[0]);
+		EXPECT(!tree.getImmediateDominator(bbs[0]));
+		EXPECT(*tree.getImmediateDominator(bbs[1]) == bbs[0]);
+		EXPECT(*tree.getImmediateDominator(bbs[2]) == bbs[1]);
+		EXPECT(*tree.getImmediateDominator(bbs[3]) == bbs[2]);
+		EXPECT(*tree.getImmediateDominator(bbs[4]) == bbs[2]);
+		EXPECT(*tree.getImmediateDominator(bbs[5]) == bbs[2]);
+		EXPECT(*tree.getImmediateDominator(bbs[6]) == bbs[1]);
+		EXPECT(tree.getChildren(bbs[2]).size() == 3);
+
+		EXPECT(tree.dominates(bbs[0], bbs[5]));
+		EXPECT(tree.dominates(bbs[5], bbs[5]));
+		EXPECT(!tree.strictlyDominates(bbs[5], bbs[5]));
+		EXPECT(!tree.dominates(bbs[3], bbs[5]));
+		EXPECT(!tree.dominates(bbs[2], bbs[6]));
+
+		EXPECT(tree.getFrontier(bbs[0]).empty());
+		EXPECT(tree.getFrontier(bbs[1]) == BasicBlockList{bbs[1]});
+		EXPECT(tree.getFrontier(bbs[3]) == BasicBlockList{bbs[5]});
+		EXPECT(tree.getFrontier(bbs[4]) == BasicBlockList{bbs[5]});
+		EXPECT(tree.getFrontier(bbs[5]) == BasicBlockList{bbs[1]});
+		EXPECT(tree.getFrontier(bbs[6]).empty());
+
+		// the set based view is derived from the tree
+		auto domMap = analysis::controlflow::getDominatorMap(fun);
+		EXPECT_PRINTABLE(domMap[bbs[5]], "{L0,L1,L4,L5}");
+	}
+
+	TEST(Analysis, PostDominatorTree)
+	{
+		string str_compound{R"({ int a = 0; while (a < 10) { if (a > 5) a = a + 2; else a = a + 1; } int b = a; })"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_compound);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto tree = analysis::controlflow::getPostDominatorTree(fun);
+		auto bbs = fun->getBasicBlocks();
+
+		// the root is the empty virtual exit, L6 is the only bb without a successor
+		EXPECT(tree.getRoot()->getInsns().empty());
+		EXPECT(*tree.getImmediateDominator(bbs[6]) == tree.getRoot());
+		EXPECT(*tree.getImmediateDominator(bbs[1]) == bbs[6]);
+		EXPECT(*tree.getImmediateDominator(bbs[0]) == bbs[1]);
+		EXPECT(*tree.getImmediateDominator(bbs[3]) == bbs[5]);
+		EXPECT(*tree.getImmediateDominator(bbs[4]) == bbs[5]);
+		EXPECT(*tree.getImmediateDominator(bbs[2]) == bbs[5]);
+
+		// both arms are control dependent on the branch of L2, the loop body on the one of L1
+		EXPECT(tree.getFrontier(bbs[3]) == BasicBlockList{bbs[2]});
+		EXPECT(tree.getFrontier(bbs[4]) == BasicBlockList{bbs[2]});
+		EXPECT(tree.getFrontier(bbs[2]) == BasicBlockList{bbs[1]});
+		EXPECT(tree.getFrontier(bbs[6]).empty());
+	}
+
 	TEST(Core, SSAIndex)
 	{
 		NodeManager manager;
@@ -290,14 +368,130 @@ namespace {
 		EXPECT_PRINTABLE(var, "a.0");
 		EXPECT(!var->hasSSAIndex());
 
-		var->setSSAIndex(0);
-		EXPECT_PRINTABLE(var, "a.0.0");
-		EXPECT(var->hasSSAIndex());
-		EXPECT(var->getSSAIndex() == 0);
-
-		var->setSSAIndex(UINT_MAX);
+		auto version = manager.buildVariable(var, 0);
+		EXPECT_PRINTABLE(version, "a.0.0");
+		EXPECT(version->hasSSAIndex());
+		EXPECT(version->getSSAIndex() == 0);
 		EXPECT_PRINTABLE(var, "a.0");
-		EXPECT(!var->hasSSAIndex());
+
+		// without an index it is the var itself
+		auto base = manager.buildVariable(version, UINT_MAX);
+		EXPECT(base == var);
+		EXPECT(!base->hasSSAIndex());
+	}
+
+	TEST(Core, Interning)
+	{
+		NodeManager manager;
+
+		auto intType = manager.buildBasicType(Type::TI_Int);
+		auto floatType = manager.buildBasicType(Type::TI_Float);
+		EXPECT(intType == manager.buildBasicType(Type::TI_Int));
+		EXPECT(intType != floatType);
+
+		// constants share the interned basic type
+		auto c1 = manager.buildIntConstant(42);
+		EXPECT(c1 == manager.buildIntConstant(42));
+		EXPECT(c1 != manager.buildIntConstant(43));
+		EXPECT(c1->getType() == intType);
+		EXPECT(manager.buildFloatConstant(1.5f) == manager.buildFloatConstant(1.5f));
+		EXPECT(manager.buildFloatConstant(1.5f)->getType() == floatType);
+
+		// one instance per array shape and function signature
+		auto arr = manager.buildArrayType(intType, 2);
+		EXPECT(arr == manager.buildArrayType(intType, 2));
+		EXPECT(arr != manager.buildArrayType(intType, 3));
+		EXPECT(arr != manager.buildArrayType(floatType, 2));
+		auto fun = manager.buildFunctionType(intType, {intType, floatType});
+		EXPECT(fun == manager.buildFunctionType(intType, {intType, floatType}));
+		EXPECT(fun != manager.buildFunctionType(intType, {floatType, intType}));
+
+		// the hash covers name, ssa index and constant payload
+		std::hash<Value> hash;
+		auto a = manager.buildVariable(intType, "a");
+		auto b = manager.buildVariable(intType, "b");
+		EXPECT(a == manager.buildVariable(intType, "a"));
+		EXPECT(hash(*a) != hash(*b));
+		EXPECT(hash(*c1) != hash(*manager.buildIntConstant(43)));
+		auto hashBefore = hash(*a);
+		EXPECT(hash(*manager.buildVariable(a, 1)) != hashBefore);
+		EXPECT(hash(*a) == hashBefore);
+	}
+
+	TEST(Core, InsnChain)
+	{
+		NodeManager manager;
+		auto type = manager.buildBasicType(Type::TI_Int);
+		auto a = manager.buildVariable(type, "a");
+		auto i1 = manager.buildAssign(a, manager.buildIntConstant(1));
+		auto i2 = manager.buildAssign(a, manager.buildIntConstant(2));
+		auto i3 = manager.buildAssign(a, manager.buildIntConstant(3));
+		auto i4 = manager.buildAssign(a, manager.buildIntConstant(4));
+
+		auto bb = manager.buildBasicBlock();
+		BasicBlock::append(bb, i2);
+		BasicBlock::append(bb, i4);
+		BasicBlock::prepend(bb, i1);
+		const auto& insns = bb->getInsns();
+		EXPECT(insns.size() == 3);
+		EXPECT(insns.front() == i1 && insns.back() == i4);
+
+		// iterators to other insns remain valid across insert & erase
+		auto pos2 = BasicBlock::getPosition(i2);
+		auto pos4 = BasicBlock::getPosition(i4);
+		EXPECT(*pos2 == i2);
+		auto pos3 = BasicBlock::insert(bb, pos4, i3);
+		EXPECT(*std::next(pos2) == i3 && *std::next(pos3) == i4);
+		EXPECT(BasicBlock::remove(bb, pos2) == pos3);
+		EXPECT(*std::prev(pos3) == i1);
+		EXPECT(insns.size() == 3);
+
+		InsnList reversed(insns.rbegin(), insns.rend());
+		EXPECT(reversed.size() == 3 && reversed[0] == i4 && reversed[2] == i1);
+		EXPECT(analysis::insn::getSuccessors(i3) == InsnList{i4});
+	}
+
+	TEST(Core, UseDefChains)
+	{
+		NodeManager manager;
+		auto type = manager.buildBasicType(Type::TI_Int);
+		auto a = manager.buildVariable(type, "a");
+		auto b = manager.buildVariable(type, "b");
+		auto c = manager.buildVariable(type, "c");
+		auto i1 = manager.buildAssign(a, manager.buildIntConstant(1));
+		auto i2 = manager.buildAssign(AssignInsn::ADD, b, a, a);
+		auto i3 = manager.buildReturn(b);
+
+		// chains are only maintained for insns within a basic block
+		auto bb = manager.buildBasicBlock();
+		BasicBlock::append(bb, i1);
+		EXPECT(a->getDefs() == InsnList{i1} && a->getUses().empty());
+		BasicBlock::append(bb, i2);
+		BasicBlock::append(bb, i3);
+		EXPECT(a->getUses() == InsnList{i2});
+		EXPECT(b->getDefs() == InsnList{i2} && b->getUses() == InsnList{i3});
+
+		// setters keep the chains up to date
+		i2->setLhs(c);
+		EXPECT(b->getDefs().empty() && c->getDefs() == InsnList{i2});
+		i2->setLhs(b);
+
+		replaceAllUsesWith(a, manager.buildIntConstant(2));
+		EXPECT(a->getUses().empty());
+		EXPECT_PRINTABLE(i2, "b = 2+2");
+		replaceAllUsesWith(b, c);
+		EXPECT(b->getUses().empty() && c->getUses() == InsnList{i3});
+
+		BasicBlock::remove(bb, BasicBlock::getPosition(i3));
+		EXPECT(c->getUses().empty());
+
+		// the size of an alloca is a use as well
+		auto i4 = manager.buildAlloca(manager.buildVariable(type, "d"), b);
+		BasicBlock::prepend(bb, i4);
+		EXPECT(b->getUses() == InsnList{i4});
+		replaceAllUsesWith(b, c);
+		EXPECT(b->getUses().empty() && c->getUses() == InsnList{i4});
+		EXPECT(*i4->getSize() == *c);
 	}
 
 	TEST(Pass, LocalValueNumbering)
@@ -365,6 +559,480 @@ namespace {
 		}
 	}
 
+	TEST(Pass, ValueNumberingTable)
+	{
+		using namespace core::passes;
+		NodeManager manager;
+		auto type = manager.buildBasicType(Type::TI_Int);
+		auto a = manager.buildVariable(type, "a");
+		auto b = manager.buildVariable(type, "b");
+		auto x = manager.buildVariable(type, "x");
+		auto y = manager.buildVariable(type, "y");
+
+		HashTable table;
+		auto sum = table.hash(manager.buildAssign(AssignInsn::ADD, x, a, b));
+		EXPECT(table.hash(manager.buildAssign(AssignInsn::ADD, y, b, a)) == sum);
+		EXPECT(table.hash(manager.buildAssign(AssignInsn::SUB, y, a, b)) != sum);
+		EXPECT(*table.find(sum) == x);
+
+		// a nested scope does not leak into its parent
+		auto mark = table.mark();
+		table.kill(x);
+		EXPECT(!table.find(sum));
+		table.hash(manager.buildAssign(AssignInsn::ADD, y, a, b));
+		EXPECT(*table.find(sum) == y);
+		table.rollback(mark);
+		EXPECT(*table.find(sum) == x);
+
+		// redefining an operand yields a new expression
+		table.kill(a);
+		EXPECT(table.hash(manager.buildAssign(AssignInsn::ADD, y, a, b)) != sum);
+	}
+
+	TEST(Pass, SSA)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			void print_int(int);
+			int main()
+			{
+				int a = 1;
+				int b = 2;
+				int i = 0;
+				while (i < 10) {
+					int t = a;
+					a = b;
+					b = t;
+					i = i + 1;
+				}
+				print_int(a - b);
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+		PassSequence encoder(manager, makePass<SSAEncoderPass>(manager));
+		encoder.apply();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		// each version has a single def, apart from allocas no insn refers to a var itself
+		for (const auto& insn : analysis::controlflow::getLinearInsnList(fun)) {
+			if (analysis::insn::isAllocaInsn(insn)) continue;
+			auto vars = analysis::insn::getInputVars(insn, analysis::insn::preds::mem);
+			auto vo = analysis::insn::getOutputVars(insn, analysis::insn::preds::mem);
+			vars.insert(vo.begin(), vo.end());
+			for (const auto& var : vars)
+				EXPECT(var->hasSSAIndex() && var->getDefs().size() == 1);
+		}
+
+		// t is not live at the loop header, hence the phis of a, b & i solely
+		auto header = analysis::controlflow::findBasicBlock(fun, [](const BasicBlockPtr& bb) {
+			return !bb->getInsns().empty() && bb->getInsns().front()->getInsnType() == Insn::IT_Phi;
+		});
+		EXPECT(header);
+		std::map<std::string, PhiInsnPtr> phis;
+		for (const auto& insn : header->getInsns()) {
+			if (insn->getInsnType() != Insn::IT_Phi) break;
+			auto phi = cast<PhiInsn>(insn);
+			phis[phi->getLhs()->getBaseName()] = phi;
+		}
+		EXPECT(phis.size() == 3 && phis.count("a.1") && phis.count("b.2") && phis.count("i.3"));
+		auto preds = analysis::controlflow::getPredecessors(fun, header);
+		EXPECT(preds.size() == 2);
+		unsigned latch = preds[0]->getInsns().back()->getInsnType() == Insn::IT_Goto ? 0 : 1;
+		EXPECT(*phis["a.1"]->getRhs()[1 - latch] == *manager.buildVariable(phis["a.1"]->getLhs(), 1));
+
+		// swap the operands of the back edge, as a propagation of the copies would do
+		auto a = phis["a.1"]->getLhs();
+		auto b = phis["b.2"]->getLhs();
+		phis["a.1"]->setRhs(latch, b);
+		phis["b.2"]->setRhs(latch, a);
+
+		PassSequence decoder(manager, makePass<SSADecoderPass>(manager));
+		decoder.apply();
+		EXPECT(header->getInsns().front()->getInsnType() != Insn::IT_Phi);
+		// the cycle on the back edge is broken by means of a temporary
+		std::vector<AssignInsnPtr> copies;
+		for (const auto& insn : preds[latch]->getInsns()) {
+			if (!analysis::insn::isAssignInsn(insn)) continue;
+			auto assign = cast<AssignInsn>(insn);
+			if (assign->isAssign() && analysis::isTemporary(assign->getLhs())) copies.push_back(assign);
+		}
+		EXPECT(copies.size() == 1);
+		auto tmp = copies.front()->getLhs();
+		EXPECT(tmp->getUses().size() == 1);
+		auto pos = BasicBlock::getPosition(copies.front());
+		EXPECT(++pos != preds[latch]->getInsns().end() && ++pos != preds[latch]->getInsns().end());
+		EXPECT(*pos == tmp->getUses().front());
+		EXPECT(analysis::insn::isGotoInsn(preds[latch]->getInsns().back()));
+	}
+
+	TEST(Pass, SSA_CriticalEdge)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			void print_int(int);
+			int read_int();
+			int main()
+			{
+				int x = 0;
+				int c = read_int();
+				if (c > 0) {
+					x = 1;
+				}
+				print_int(x);
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+		PassSequence encoder(manager, makePass<SSAEncoderPass>(manager));
+		encoder.apply();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto entry = analysis::controlflow::getEntryPoint(fun);
+		auto join = analysis::controlflow::findBasicBlock(fun, [](const BasicBlockPtr& bb) {
+			return !bb->getInsns().empty() && bb->getInsns().front()->getInsnType() == Insn::IT_Phi;
+		});
+		EXPECT(join);
+		// the value of c reaches the join via the jump of the entry, which enforces a copy there
+		auto phi = cast<PhiInsn>(join->getInsns().front());
+		auto c = manager.buildVariable(manager.buildVariable(manager.buildBasicType(Type::TI_Int), "c.2"), 1);
+		phi->setRhs(analysis::controlflow::getPredecessors(fun, join)[0] == entry ? 0 : 1, c);
+
+		PassSequence decoder(manager, makePass<SSADecoderPass>(manager), makePass<IntegrityPass>(manager));
+		decoder.apply();
+		EXPECT(fun->getBasicBlocks().size() == 4);
+		auto jump = cast<FalseJumpInsn>(entry->getInsns().back());
+		EXPECT(*jump->getTarget() != *join->getLabel());
+		auto bb = analysis::controlflow::findBasicBlock(fun, [&](const BasicBlockPtr& bb) {
+			return *bb->getLabel() == *jump->getTarget();
+		});
+		EXPECT(bb && bb->getInsns().size() == 2);
+		auto copy = cast<AssignInsn>(bb->getInsns().front());
+		EXPECT(copy->getLhs()->getBaseName() == "x.1" && cast<Variable>(copy->getRhs1())->getBaseName() == "c.2");
+		EXPECT(analysis::controlflow::getSuccessors(fun, bb).size() == 1);
+		EXPECT(*analysis::controlflow::getSuccessors(fun, bb)[0] == *join);
+		EXPECT(!fun->getGraph().hasEdge(entry, join));
+		// the then branch still falls through into the join
+		auto bbs = analysis::controlflow::getLinearBasicBlockList(fun);
+		EXPECT(bbs.size() == 4 && *bbs[2] == *join && *bbs[3] == *bb);
+	}
+
+	TEST(Pass, SCCP)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			int read_int();
+			void print_int(int);
+			int main() {
+				int x = 3;
+				int y = 0;
+				if (x > 2) {
+					y = x * 2;
+				} else {
+					y = read_int();
+				}
+				int i = 0;
+				while (i < 10) {
+					x = y - 3;
+					i = i + 1;
+				}
+				print_int(x);
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+		PassSequence seq(manager, makePass<SSAEncoderPass>(manager),
+			makePass<SparseConditionalConstantPropagationPass>(manager),
+			makePass<SSADecoderPass>(manager), makePass<IntegrityPass>(manager));
+		seq.apply();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		// the else branch is never taken, hence the only jump left is the one of the loop
+		unsigned jumps = 0, calls = 0;
+		PushInsnPtr push;
+		for (const auto& insn : analysis::controlflow::getLinearInsnList(fun)) {
+			if (analysis::insn::isFalseJumpInsn(insn)) ++jumps;
+			if (analysis::insn::isCallInsn(insn)) ++calls;
+			if (analysis::insn::isPushInsn(insn)) push = cast<PushInsn>(insn);
+		}
+		EXPECT(jumps == 1 && calls == 1);
+		EXPECT(analysis::controlflow::getLinearBasicBlockList(fun).size() == fun->getBasicBlocks().size());
+		// x is the same on both edges into the loop header
+		EXPECT(push && *push->getRhs() == *manager.buildIntConstant(3));
+	}
+
+	TEST(Pass, ADCE)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			int read_int();
+			void print_int(int);
+			int main() {
+				int n = read_int();
+				int dead = n * 3;
+				int i = 0;
+				int s = 0;
+				while (i < n) {
+					s = s + i;
+					i = i + 1;
+				}
+				int t = 0;
+				if (n > 2) {
+					t = 5;
+				} else {
+					t = 6;
+				}
+				if (n > 5) {
+					print_int(n);
+				}
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+		PassSequence seq(manager, makePass<SSAEncoderPass>(manager),
+			makePass<AggressiveDeadCodeEliminationPass>(manager),
+			makePass<SSADecoderPass>(manager), makePass<IntegrityPass>(manager));
+		seq.apply();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		// the loop and the first branch are gone, the call depends on the second one
+		unsigned jumps = 0, assigns = 0;
+		for (const auto& insn : analysis::controlflow::getLinearInsnList(fun)) {
+			if (analysis::insn::isFalseJumpInsn(insn)) ++jumps;
+			if (analysis::insn::isAssignInsn(insn)) ++assigns;
+		}
+		EXPECT(jumps == 1);
+		// the result of read_int is copied into n, which is compared thereafter
+		EXPECT(assigns == 2);
+		EXPECT(analysis::controlflow::getLinearBasicBlockList(fun).size() == fun->getBasicBlocks().size());
+	}
+
+	TEST(Pass, LICM)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			int read_int();
+			void print_int(int);
+			int main() {
+				int n = read_int();
+				int a[4][5];
+				int i = 0;
+				while (i < 4) {
+					int j = 0;
+					while (j < 5) {
+						a[i][j] = (i * j) + (n * 3);
+						j = j + 1;
+					}
+					i = i + 1;
+				}
+				int s = 0;
+				if (n > 2)
+					while (s < 100) {
+						s = s + a[n / 2][1];
+						if (s > 50) print_int(a[n][2]);
+					}
+				print_int(s);
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+
+		// the empty then branch is dropped, thus the last loop is entered by a false jump
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto& graph = fun->getGraph();
+		auto bbs = fun->getBasicBlocks();
+		auto it = std::find_if(bbs.begin(), bbs.end(), [&](const BasicBlockPtr& bb) {
+			return bb->getInsns().empty() && analysis::controlflow::getPredecessors(fun, bb).size() == 1;
+		});
+		EXPECT(it != bbs.end());
+		auto pred = analysis::controlflow::getPredecessors(fun, *it).front();
+		auto header = analysis::controlflow::getSuccessors(fun, *it).front();
+		graph.removeVertex(*it);
+		graph.addEdge(pred, header);
+
+		auto licm = std::make_shared<LoopInvariantCodeMotionPass>(manager);
+		PassSequence seq(manager, makePass<SSAEncoderPass>(manager), PassPtr(licm),
+			makePass<SSADecoderPass>(manager), makePass<IntegrityPass>(manager));
+		seq.apply();
+
+		// i*5 and n*3 leave the inner loop, the latter leaves the outer one as well. the
+		// guarded load remains, whereas its address is computed ahead
+		const auto& report = licm->getReport();
+		EXPECT(report.size() == 3);
+		EXPECT(report[0].second == 2);
+		EXPECT(report[1].second == 1);
+		EXPECT(*report[2].first == *header->getLabel());
+		EXPECT(report[2].second == 10);
+
+		// a new preheader takes over the edge of the false jump, it receives the load
+		auto preds = analysis::controlflow::getPredecessors(fun, header);
+		EXPECT(preds.size() == 2);
+		EXPECT(std::none_of(preds.begin(), preds.end(),
+			[&](const BasicBlockPtr& bb) { return *bb == *pred; }));
+		unsigned loads = 0;
+		for (const auto& bb : preds) {
+			for (const auto& insn : bb->getInsns())
+				if (analysis::insn::isLoadInsn(insn)) ++loads;
+		}
+		EXPECT(loads == 1);
+		EXPECT(analysis::controlflow::getLinearBasicBlockList(fun).size() == fun->getBasicBlocks().size());
+	}
+
+	TEST(Pass, IVSR)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			int read_int();
+			void print_int(int);
+			int main() {
+				int a[10];
+				int i = 0;
+				while (i < 10) {
+					a[i] = read_int();
+					i = i + 1;
+				}
+				int s = 0;
+				i = 0;
+				while (i < 10) {
+					s = s + a[i];
+					i = i + 1;
+				}
+				print_int(s);
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+
+		// the increments are inlined into their copies first, as in the pipeline
+		PassSequence seq(manager, makePass<InlineAssignmentsPass>(manager), makePass<SSAEncoderPass>(manager),
+			makePass<LoopInvariantCodeMotionPass>(manager), makePass<InductionVariableStrengthReductionPass>(manager),
+			makePass<SSADecoderPass>(manager), makePass<IntegrityPass>(manager));
+		seq.apply();
+
+		// the byte offsets are bumped by 4 instead of scaling i, which is only compared
+		// against 10 otherwise. thus both tests are replaced and i is gone entirely. the
+		// decoder names the versions of i after their ssa index
+		auto isI = [](const VariablePtr& var) { return var->getBaseName().compare(0, 2, "i.") == 0; };
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		unsigned tests = 0;
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (const auto& insn : bb->getInsns()) {
+				if (!analysis::insn::isAssignInsn(insn)) continue;
+				auto assign = cast<AssignInsn>(insn);
+				EXPECT(assign->getOp() != AssignInsn::MUL);
+				EXPECT(!isI(assign->getLhs()));
+				if (assign->getOp() != AssignInsn::LT) continue;
+				EXPECT(analysis::isIntConstant(assign->getRhs2()));
+				EXPECT(arithmetic::getValue<int>(assign->getRhs2()) == 40);
+				++tests;
+			}
+		}
+		EXPECT(tests == 2);
+	}
+
+	TEST(Pass, IVSR_Overflow)
+	{
+		using namespace core::passes;
+		string str_program{R"(
+			int read_int();
+			void print_int(int);
+			int main() {
+				int n = read_int();
+				int s = 0;
+				int c = 0;
+				int i = 0;
+				while (i < n) {
+					s = s + i * 100000;
+					c = c + 1;
+					i = i + 1;
+				}
+				i = 0;
+				while (i < 30000) {
+					s = s + i * 100000;
+					c = c + 1;
+					i = i + 1;
+				}
+				print_int(s);
+				print_int(c);
+				return 0;
+			})"};
+
+		NodeManager manager;
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+
+		PassSequence seq(manager, makePass<InlineAssignmentsPass>(manager), makePass<SSAEncoderPass>(manager),
+			makePass<LoopInvariantCodeMotionPass>(manager), makePass<InductionVariableStrengthReductionPass>(manager),
+			makePass<SSADecoderPass>(manager), makePass<IntegrityPass>(manager));
+		seq.apply();
+
+		// the scaled bounds do not fit into an int, thus both loops still test i
+		auto isI = [](const VariablePtr& var) { return var->getBaseName().compare(0, 2, "i.") == 0; };
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		unsigned tests = 0;
+		for (const auto& bb : fun->getBasicBlocks()) {
+			for (const auto& insn : bb->getInsns()) {
+				if (!analysis::insn::isAssignInsn(insn)) continue;
+				auto assign = cast<AssignInsn>(insn);
+				if (assign->getOp() != AssignInsn::LT) continue;
+				EXPECT(analysis::isVariable(assign->getRhs1()) && isI(cast<Variable>(assign->getRhs1())));
+				++tests;
+			}
+		}
+		EXPECT(tests == 2);
+	}
+
+	TEST(Analysis, ExtendedBasicBlocksChain)
+	{
+		NodeManager manager;
+		auto fun = manager.buildFunction("chain",
+			manager.buildFunctionType(manager.buildBasicType(Type::TI_Void), TypeList{}), VariableList{});
+		auto& graph = fun->getGraph();
+
+		// long enough to exhaust the small stack below by a recursive traversal
+		const unsigned length = 10000;
+		BasicBlockList bbs;
+		for (unsigned i = 0; i < length; ++i) {
+			bbs.push_back(manager.buildBasicBlock());
+			bbs.back()->setLabel(manager.buildLabel());
+			graph.addVertex(bbs.back());
+			if (i) graph.addEdge(bbs[i - 1], bbs[i]);
+		}
+		// a back edge makes the second bb a leader
+		graph.addEdge(bbs.back(), bbs[1]);
+
+		std::pair<FunctionPtr, std::vector<BasicBlockList>> chain(fun, {});
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setstacksize(&attr, 128 * 1024);
+		pthread_t thread;
+		EXPECT(pthread_create(&thread, &attr, [](void* arg) -> void* {
+			auto chain = static_cast<std::pair<FunctionPtr, std::vector<BasicBlockList>>*>(arg);
+			chain->second = analysis::controlflow::getExtendedBasicBlocks(chain->first);
+			return nullptr;
+		}, &chain) == 0);
+		pthread_join(thread, nullptr);
+		pthread_attr_destroy(&attr);
+
+		const auto& ebbs = chain.second;
+		EXPECT(ebbs.size() == 2);
+		EXPECT(ebbs[0] == BasicBlockList{bbs[0]});
+		EXPECT(ebbs[1].size() == length - 1);
+		EXPECT(ebbs[1].front() == bbs[1] && ebbs[1].back() == bbs.back());
+	}
+
 	TEST(Analysis, ExtendedBasicBlocks)
 	{
 		using namespace core::passes;
@@ -614,6 +1282,94 @@ namespace {
 		}
 	}
 
+	TEST(Analysis, TwoLevelLiveness)
+	{
+		using namespace core::analysis::worklist;
+		NodeManager manager;
+
+		string str_compound{R"(
+		{
+			int a = 3;
+			int b = 5;
+			int c = a * b;
+			while (a < 10) {
+				if (c > b) c = c - 1;
+				a = a + c;
+			}
+			int d = c + a;
+		})"};
+
+		frontend::Converter converter(manager, str_compound);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto insns = analysis::controlflow::getLinearInsnList(fun);
+		// the insn level fixpoint serves as reference
+		InsnLiveness reference;
+		reference.apply(insns.begin(), insns.end());
+
+		TwoLevelLiveness liveness;
+		liveness.apply(fun);
+		EXPECT(liveness.getNodeData().size() == insns.size());
+		for (const auto& insn : insns) {
+			const auto& data = liveness.getNodeData().at(insn);
+			// answered by the bitsets, before the sets are converted below
+			for (const auto& var : reference.getNodeData().at(insn)->getLiveOut()) EXPECT(data->isLiveOut(var));
+			for (const auto& var : analysis::controlflow::getAllVars(fun, true))
+				EXPECT(data->isLiveIn(var) == reference.getNodeData().at(insn)->isLiveIn(var));
+			EXPECT(toString(*data) == toString(*reference.getNodeData().at(insn)));
+		}
+	}
+
+	TEST(Analysis, ReachingDefinitions)
+	{
+		using namespace core::analysis::worklist;
+		NodeManager manager;
+
+		string str_compound{R"(
+		{
+			int a = 3;
+			int b = 5;
+			int c = a * b;
+			while (a < 10) {
+				a = a + 1;
+				c = a * b;
+			}
+			int d = c;
+		})"};
+
+		frontend::Converter converter(manager, str_compound);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto bbs = fun->getBasicBlocks();
+		auto join = [](const PtrList<Insn>& insns) {
+			std::string result;
+			for (const auto& insn : insns) result += toString(*insn) + "; ";
+			return result;
+		};
+
+		ReachingDefinitions rd(fun);
+		rd.apply(bbs.begin(), bbs.end());
+		EXPECT(rd.getDefinitionsIn(bbs[0]).empty());
+		// both definitions of a & c reach the loop header as well as the exit
+		EXPECT(join(rd.getDefinitionsIn(bbs[1])) ==
+			"a.0 = 3; b.1 = 5; $0 = a.0*b.1; c.2 = $0; $1 = a.0<10; $2 = a.0+1; a.0 = $2; $3 = a.0*b.1; c.2 = $3; ");
+		EXPECT(join(rd.getDefinitionsIn(bbs[3])) == join(rd.getDefinitionsIn(bbs[1])));
+		EXPECT(join(rd.getDefinitionsOut(bbs[2])) ==
+			"b.1 = 5; $0 = a.0*b.1; $1 = a.0<10; $2 = a.0+1; a.0 = $2; $3 = a.0*b.1; c.2 = $3; ");
+
+		AvailableExpressions ae(fun);
+		ae.apply(bbs.begin(), bbs.end());
+		EXPECT(ae.getExpressionsIn(bbs[0]).empty());
+		// a*b is recomputed after a has been modified within the loop
+		auto available = ae.getExpressionsIn(bbs[1]);
+		EXPECT(join({available.begin(), available.end()}) == "$0 = a.0*b.1; ");
+		EXPECT(ae.getExpressionsOut(bbs[1]).size() == 2);
+		EXPECT(ae.getExpressionsOut(bbs[2]).size() == 1);
+		EXPECT(ae.getExpressionsIn(bbs[3]).size() == 2);
+	}
+
 	TEST(Converter, While)
 	{
 		using namespace core::passes;
@@ -1326,6 +2082,14 @@ namespace {
 		EXPECT_PRINTABLE(insn, "subl $0x4,%esp\nmovss %xmm0,0(%esp)");
 	}
 
+	TEST(MachineInsn, PopXmm3)
+	{
+		using namespace backend::insn;
+		auto rhs1 = buildRegOperand(MachineOperand::OR_Xmm3, MachineOperand::OS_32Bit);
+		auto insn = buildPopTemplate(rhs1);
+		EXPECT_PRINTABLE(insn, "movss 0(%esp),%xmm3\naddl $0x4,%esp");
+	}
+
 	TEST(Backend, StackFrame)
 	{
 		string str_program{R"(
@@ -1412,6 +2176,323 @@ namespace {
 			EXPECT(offset == fooFrame->getRelativeOffset(var));
 			offset += 4;
 		}
+
+		// scratch space for %edx, %xmm2 - %xmm7, %ecx and %eax follows the locals
+		int bytes = fooFrame->getNumOfBytesLocals();
+		EXPECT(fooFrame->getRelativeOffset(backend::insn::MachineOperand::OR_Edx) == -(4 + bytes));
+		EXPECT(fooFrame->getRelativeOffset(backend::insn::MachineOperand::OR_Xmm7) == -(28 + bytes));
+		EXPECT(fooFrame->getRelativeOffset(backend::insn::MachineOperand::OR_Eax) == -(36 + bytes));
+		EXPECT(fooFrame->getNumOfBytesFrame() == fooFrame->getNumOfBytesLocals() + 36);
+	}
+
+	TEST(Backend, StackFrame_Slots)
+	{
+		using namespace core::analysis::worklist;
+		NodeManager manager;
+
+		string str_program{R"(
+			void print_int(int);
+			int main()
+			{
+				int big[8];
+				int a = 1;
+				int small[2];
+				print_int(a);
+				int b = a + 2;
+				print_int(b);
+				int c = 3;
+				print_int(c);
+				big[1] = c;
+				small[0] = b;
+				return 0;
+			})"};
+
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		TwoLevelLiveness liveness;
+		liveness.apply(fun);
+		VariableSet spilled;
+		std::map<std::string, VariablePtr> vars;
+		for (const auto& var : analysis::controlflow::getAllVars(fun, true)) {
+			vars[toString(*var)] = var;
+			if (!analysis::types::isArray(var->getType())) spilled.insert(var);
+		}
+		auto frame = backend::memory::getStackFrame(fun, liveness, spilled);
+		auto offset = [&](const std::string& name) { return frame->getRelativeOffset(vars[name]); };
+
+		// the arrays follow the scalars by increasing size
+		for (const auto& var : spilled) EXPECT(frame->getRelativeOffset(var) > offset("small.3"));
+		EXPECT(offset("small.3") > offset("big.1"));
+		EXPECT(offset("small.3") - offset("big.1") == 32);
+		// vars which are live resp. written at the same insn never share a slot
+		for (const auto& pair : liveness.getNodeData()) {
+			std::set<int> used;
+			VariableSet live(pair.second->getLiveIn());
+			for (const auto& set : { pair.second->getLiveOut(), analysis::insn::getOutputVars(pair.first) })
+				live.insert(set.begin(), set.end());
+			for (const auto& var : live)
+				if (spilled.count(var)) EXPECT(used.insert(frame->getRelativeOffset(var)).second);
+		}
+		EXPECT(offset("b.4") != offset("c.5"));
+		// less than a slot per var, yet both arrays as a whole
+		auto unshared = backend::memory::getStackFrame(fun);
+		EXPECT(frame->getNumOfBytesLocals() < unshared->getNumOfBytesLocals());
+		EXPECT(frame->getNumOfBytesLocals() >= 32 + 8);
+	}
+
+	TEST(Backend, LinearScan)
+	{
+		using namespace core::analysis::worklist;
+		NodeManager manager;
+
+		string str_compound{R"(
+		{
+			int a = 1;
+			int b = 2;
+			int c = 3;
+			int d = 4;
+			int e = 5;
+			int f = 6;
+			while (a < 100) {
+				int g = a;
+				a = g + b * c + d * e + f;
+			}
+			int h = a + b + c + d + e + f;
+		})"};
+
+		frontend::Converter converter(manager, str_compound);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto bbs = analysis::controlflow::getLinearBasicBlockList(fun);
+		auto insns = analysis::controlflow::getLinearInsnList(bbs);
+		TwoLevelLiveness liveness;
+		liveness.apply(fun);
+
+		auto intervals = analysis::intervals::getLiveIntervals(fun, Type::TI_Int, liveness, bbs);
+		auto graph = backend::linearscan::getAllocationGraph(intervals, Type::TI_Int, insns);
+		auto mappings = backend::linearscan::getRegisterMappings(intervals, graph, 4);
+		EXPECT(mappings.size() == intervals.size());
+
+		std::map<VariablePtr, int, target_less<Variable>> colors;
+		unsigned spilled = 0;
+		for (unsigned i = 0; i < mappings.size(); ++i) {
+			EXPECT(*mappings[i].vertex == *intervals[i].var);
+			EXPECT(mappings[i].color < 4 && (mappings[i].color >= 0 || mappings[i].flag));
+			if (mappings[i].color < 0) ++spilled;
+			colors[mappings[i].vertex] = mappings[i].color;
+		}
+		// more vars than registers are live within the loop
+		EXPECT(spilled > 0);
+		// vars which are live at the same time never share a register
+		for (const auto& insn : insns) {
+			const auto& data = liveness.getNodeData().at(insn);
+			for (const auto& vars : { data->getLiveIn(), data->getLiveOut() }) {
+				std::set<int> used;
+				for (const auto& var : vars) {
+					int color = colors.count(var) ? colors[var] : -1;
+					if (color >= 0) EXPECT(used.insert(color).second);
+				}
+			}
+		}
+		// the register of a copied var is preferred over the lowest free one
+		analysis::intervals::LiveIntervals copies{
+			{intervals[0].var, 0, 2, nullptr}, {intervals[1].var, 0, 2, nullptr},
+			{intervals[2].var, 1, 4, nullptr}, {intervals[3].var, 3, 6, intervals[1].var}};
+		graph::color::AllocationGraph<Variable> copiesGraph;
+		for (const auto& interval : copies) copiesGraph.addVertex(interval.var);
+		auto hinted = backend::linearscan::getRegisterMappings(copies, copiesGraph, 3);
+		EXPECT(hinted[2].color == 2 && hinted[3].color == 1);
+		// unless the register of the source is forbidden
+		copiesGraph.forbidColor(3, 1);
+		hinted = backend::linearscan::getRegisterMappings(copies, copiesGraph, 3);
+		EXPECT(hinted[3].color == 0);
+	}
+
+	TEST(Backend, LinearScan_Dense)
+	{
+		// a straight-line function in which every var stays alive until the end,
+		// thus the interference graph is dense. the scan never builds its edges
+		const unsigned n = 60;
+		NodeManager manager;
+		std::stringstream ss;
+		ss << "{ int v0 = 1;";
+		for (unsigned i = 1; i < n; ++i) ss << "int v" << i << " = v" << i - 1 << " + 1;";
+		ss << "int s = 0;";
+		for (unsigned i = 0; i < n; ++i) ss << "s = s + v" << i << ";";
+		ss << "}";
+		frontend::Converter converter(manager, ss.str());
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto bbs = analysis::controlflow::getLinearBasicBlockList(fun);
+		auto insns = analysis::controlflow::getLinearInsnList(bbs);
+		analysis::worklist::TwoLevelLiveness liveness;
+		liveness.apply(fun);
+
+		auto intervals = analysis::intervals::getLiveIntervals(fun, Type::TI_Int, liveness, bbs);
+		auto allocation = backend::linearscan::getAllocationGraph(intervals, Type::TI_Int, insns);
+		auto scan = backend::linearscan::getRegisterMappings(intervals, allocation, 4);
+		EXPECT(scan.size() == intervals.size() && scan.size() >= n);
+		for (unsigned i = 0; i < allocation.numberOfVertices(); ++i) EXPECT(allocation.getDegree(i) == 0);
+
+		// whereas coloring has to build all n^2 / 2 edges first
+		auto graph = analysis::interference::getInterferenceGraph(fun, Type::TI_Int, liveness, insns);
+		size_t degrees = 0;
+		for (unsigned i = 0; i < graph.numberOfVertices(); ++i) degrees += graph.getDegree(i);
+		EXPECT(degrees >= n * (n - 1));
+
+		// all of the 4 registers are in use, the rest is spilled
+		std::set<int> colors;
+		for (const auto& mapping : scan) colors.insert(mapping.color);
+		EXPECT(colors.size() == 5 && colors.count(-1));
+	}
+
+	TEST(Backend, LiveRangeSplitting)
+	{
+		using namespace core::analysis::worklist;
+		NodeManager manager;
+
+		string str_program{R"(
+			void print_int(int);
+			int read_int();
+			int main()
+			{
+				int a = read_int();
+				int b = read_int();
+				print_int(a);
+				while (a < 100) {
+					a = a + b;
+					b = b + 1;
+				}
+				print_int(a);
+				print_int(b);
+				int c = a + b;
+				int d = c + a;
+				print_int(d);
+				return 0;
+			})"};
+
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto bbs = analysis::controlflow::getLinearBasicBlockList(fun);
+		auto liveCalls = [&]() {
+			TwoLevelLiveness liveness;
+			liveness.apply(fun);
+			VariableSet result;
+			for (const auto& insn : analysis::controlflow::getLinearInsnList(bbs)) {
+				if (!analysis::insn::isCallInsn(insn)) continue;
+				auto defs = analysis::insn::getOutputVars(insn);
+				for (const auto& var : liveness.getNodeData().at(insn)->getLiveOut())
+					if (!defs.count(var)) result.insert(var);
+			}
+			return result;
+		};
+		auto before = toString(*fun);
+		auto vars = liveCalls();
+		EXPECT(!vars.empty());
+
+		TwoLevelLiveness liveness;
+		liveness.apply(fun);
+		auto all = analysis::controlflow::getAllVars(fun);
+		auto pieces = backend::split::splitLiveRanges(manager, fun, bbs, liveness, all);
+		// a and b within the loop, a in between the last calls
+		EXPECT(pieces.size() == 3);
+		for (const auto& pair : pieces) EXPECT(vars.count(pair.second));
+		// each piece is a fresh temporary, it never equals a var of the program
+		for (const auto& pair : pieces) EXPECT(!all.count(pair.first) && analysis::isTemporary(pair.first));
+		// none of the pieces lives across a call
+		for (const auto& var : liveCalls()) EXPECT(!pieces.count(var));
+		EXPECT(toString(*fun) != before);
+
+		backend::split::joinLiveRanges(pieces);
+		EXPECT(toString(*fun) == before);
+	}
+
+	TEST(Backend, Rematerialization)
+	{
+		NodeManager manager;
+
+		string str_program{R"(
+			void print_int(int);
+			int read_int();
+			int main()
+			{
+				int a[4];
+				int k = 7;
+				int j = k;
+				int n = read_int();
+				n = n + k;
+				a[2] = n;
+				a[n] = j;
+				print_int(a[2] + j);
+				return 0;
+			})"};
+
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+		// without the ssa stage, as it would propagate the copy of k
+		passes::PassSequence seq(manager,
+			passes::makePass<passes::InlineAssignmentsPass>(manager),
+			passes::makePass<passes::NormalizeAssignmentsPass>(manager),
+			passes::makePass<passes::SuperLocalValueNumberingPass>(manager));
+		seq.apply();
+
+		auto fun = analysis::callgraph::getMainFunction(manager.getProgram());
+		auto bbs = analysis::controlflow::getLinearBasicBlockList(fun);
+		std::map<std::string, AssignInsnPtr> defs;
+		for (const auto& pair : backend::regalloc::getRematerializable(fun, bbs))
+			defs[toString(*pair.first)] = pair.second;
+		// the constants and the elements with a constant index
+		EXPECT(defs.count("k.2") && defs["k.2"]->isAssign());
+		EXPECT(defs.count("$3") && defs.count("$7") && analysis::isOffset(defs["$7"]->getLhs()));
+		// a copy is mapped onto the def of its source
+		EXPECT(defs.count("j.3") && defs["j.3"] == defs["k.2"]);
+		// assigned twice resp. an element with a variable index
+		EXPECT(!defs.count("n.4") && !defs.count("$5"));
+	}
+
+	TEST(Backend, CallResult)
+	{
+		NodeManager manager;
+
+		// x is live across the 2nd call, thus its register is saved around it
+		string str_program{R"(
+			float read_float();
+			void print_float(float);
+			int main()
+			{
+				float x = read_float();
+				float y = read_float();
+				print_float(x + y);
+				return 0;
+			})"};
+
+		frontend::Converter converter(manager, str_program);
+		converter.convert();
+		auto backend = backend::makeRegAllocBackend(manager);
+		EXPECT(backend->convert());
+
+		std::stringstream ss;
+		backend->printTo(ss);
+		// the register receiving the result of a call is not restored afterwards
+		std::string line, result;
+		unsigned calls = 0;
+		while (std::getline(ss, line)) {
+			if (line.empty()) result.clear();
+			else if (!result.empty())
+				EXPECT(line.size() < result.size() || line.compare(line.size() - result.size(), result.size(), result) != 0);
+			else if (line == "call read_float" && std::getline(ss, line)) {
+				EXPECT(line.compare(0, 12, "movss %xmm0,") == 0);
+				result = line.substr(11);
+				++calls;
+			}
+		}
+		EXPECT(calls == 2);
 	}
 
 	TEST(Utils, ColorGraph_ThreeColorable)
@@ -1476,6 +2557,201 @@ namespace {
 		EXPECT(*mapping[3].vertex == *vertices[3] && mapping[3].color == 0);
 	}
 
+	TEST(Utils, AllocationGraph)
+	{
+		using namespace graph::color;
+		AllocationGraph<int> graph;
+
+		std::vector<AllocationGraph<int>::vertex_type> vertices(4);
+		for (unsigned i = 0 ; i < vertices.size(); ++i) vertices[i] = makeVertex<int>(i);
+
+		// a triangle with a tail, edges are recorded only once
+		graph.addEdge(vertices[0], vertices[1]);
+		graph.addEdge(vertices[1], vertices[2]);
+		graph.addEdge(vertices[2], vertices[0]);
+		graph.addEdge(vertices[0], vertices[2]);
+		graph.addEdge(vertices[2], vertices[3]);
+		EXPECT(graph.numberOfVertices() == 4);
+		EXPECT(graph.getDegree(2) == 3);
+		EXPECT(graph.hasEdge(1, 0) && !graph.hasEdge(3, 0));
+		EXPECT(graph.getIndex(makeVertex<int>(3)) == 3);
+
+		// the vertex of the lowest weight per degree is spilled
+		graph.setWeight(0, 3.0);
+		graph.setWeight(1, 2.0);
+		graph.setWeight(2, 10.0);
+		auto mapping = getColorMappings(graph, 2);
+		EXPECT(*mapping[1].vertex == *vertices[1] && mapping[1].flag && mapping[1].color == -1);
+		EXPECT(mapping[0].color >= 0 && mapping[2].color >= 0 && mapping[0].color != mapping[2].color);
+		EXPECT(mapping[3].color >= 0 && mapping[3].color != mapping[2].color);
+		mapping = getColorMappings(graph, 3);
+		for (unsigned i = 0; i < 4; ++i) {
+			EXPECT(mapping[i].color >= 0);
+			for (unsigned j : graph.getNeighbours(i)) EXPECT(mapping[i].color != mapping[j].color);
+		}
+		// forbidden colors are never selected
+		graph.forbidColor(3, 0);
+		EXPECT(graph.isForbidden(3, 0) && !graph.isForbidden(3, 1));
+		mapping = getColorMappings(graph, 3);
+		EXPECT(mapping[3].color > 0 && mapping[3].color != mapping[2].color);
+	}
+
+	TEST(Utils, AllocationGraph_Coalescing)
+	{
+		using namespace graph::color;
+		AllocationGraph<int> graph;
+
+		std::vector<AllocationGraph<int>::vertex_type> vertices(5);
+		for (unsigned i = 0 ; i < vertices.size(); ++i) graph.addVertex(vertices[i] = makeVertex<int>(i));
+
+		// 0 -> 1 may share a color, 2 -> 3 may not as they interfere
+		graph.addEdge(vertices[0], vertices[2]);
+		graph.addEdge(vertices[1], vertices[4]);
+		graph.addEdge(vertices[2], vertices[3]);
+		graph.addMove(vertices[0], vertices[1]);
+		graph.addMove(vertices[2], vertices[3]);
+		graph.addMove(vertices[4], vertices[4]);
+		EXPECT(graph.getMoves().size() == 2);
+
+		auto mapping = getColorMappings(graph, 2);
+		for (unsigned i = 0; i < 5; ++i) EXPECT(mapping[i].color >= 0);
+		EXPECT(mapping[0].color == mapping[1].color);
+		EXPECT(mapping[2].color != mapping[3].color);
+		EXPECT(mapping[0].color != mapping[2].color && mapping[1].color != mapping[4].color);
+	}
+
+	TEST(Utils, Graph_Adjacency)
+	{
+		DirectedGraph<int> graph;
+
+		std::vector<DirectedGraph<int>::vertex_type> vertices(4);
+		for (unsigned i = 0 ; i < vertices.size(); ++i) vertices[i] = makeVertex<int>(i);
+
+		EXPECT(graph.addEdge(vertices[0], vertices[1]));
+		EXPECT(graph.addEdge(vertices[0], vertices[2]));
+		EXPECT(graph.addEdge(vertices[1], vertices[3]));
+		EXPECT(graph.addEdge(vertices[2], vertices[3]));
+		EXPECT(graph.addEdge(vertices[3], vertices[3]));
+		// neither vertices nor edges are inserted twice, also not by value
+		EXPECT(!graph.addEdge(makeVertex<int>(0), makeVertex<int>(1)));
+		EXPECT(!graph.addVertex(makeVertex<int>(2)));
+		EXPECT(graph.numberOfVertices() == 4);
+		EXPECT(graph.numberOfEdges() == 5);
+		EXPECT(graph.hasEdge(vertices[1], vertices[3]));
+		EXPECT(!graph.hasEdge(vertices[3], vertices[1]));
+
+		auto preds = graph.getPredecessors(vertices[3]);
+		EXPECT(preds.size() == 3);
+		EXPECT(*preds[0] == 1 && *preds[1] == 2 && *preds[2] == 3);
+		EXPECT(graph.getSuccessors(vertices[0]).size() == 2);
+		EXPECT(graph.getConnectedEdges(vertices[3], Direction::ANY).size() == 3);
+		EXPECT(graph.getSuccessors(makeVertex<int>(42)).empty());
+
+		EXPECT(graph.removeVertex(vertices[1]));
+		EXPECT(!graph.removeVertex(vertices[1]));
+		EXPECT(graph.numberOfVertices() == 3);
+		EXPECT(graph.numberOfEdges() == 3);
+		EXPECT(graph.getSuccessors(vertices[0]).size() == 1);
+		EXPECT(graph.getPredecessors(vertices[3]).size() == 2);
+
+		EXPECT(graph.removeEdge(vertices[2], vertices[3]));
+		EXPECT(!graph.removeEdge(vertices[2], vertices[3]));
+		EXPECT(graph.numberOfEdges() == 2);
+		EXPECT(!graph.hasEdge(vertices[2], vertices[3]));
+		EXPECT(graph.getSuccessors(vertices[2]).empty());
+		EXPECT(graph.getPredecessors(vertices[3]).size() == 1);
+
+		UndirectedGraph<int> ugraph;
+		EXPECT(ugraph.addEdge(vertices[0], vertices[1]));
+		EXPECT(!ugraph.addEdge(vertices[1], vertices[0]));
+		EXPECT(ugraph.addEdge(vertices[1], vertices[1]));
+		EXPECT(ugraph.addEdge(vertices[2], vertices[1]));
+		EXPECT(ugraph.getConnectedEdges(vertices[1]).size() == 3);
+		EXPECT(ugraph.getConnectedVertices(vertices[1]).size() == 2);
+		// the reversed edge is the same one
+		EXPECT(ugraph.removeEdge(vertices[1], vertices[2]));
+		EXPECT(ugraph.getConnectedVertices(vertices[1]).size() == 1);
+		EXPECT(ugraph.addEdge(vertices[2], vertices[1]));
+
+		ugraph.removeVertex(vertices[1]);
+		EXPECT(ugraph.numberOfEdges() == 0);
+		EXPECT(ugraph.getConnectedVertices(vertices[0]).empty());
+	}
+
+	TEST(Utils, Graph_BackEdges)
+	{
+		// a cfg-like chain of n blocks where each one also branches back to the
+		// entry, the neighbours of each block are its own edges only
+		const unsigned n = 1000;
+		NodeManager manager;
+		BasicBlockList bbs;
+		for (unsigned i = 0; i < n; ++i) {
+			bbs.push_back(std::make_shared<BasicBlock>());
+			bbs.back()->setLabel(manager.buildLabel());
+		}
+
+		DirectedGraph<BasicBlock> cfg;
+		for (unsigned i = 0; i + 1 < n; ++i) {
+			cfg.addEdge(bbs[i], bbs[i + 1]);
+			cfg.addEdge(bbs[i + 1], bbs[0]);
+		}
+		size_t degrees = 0;
+		for (const auto& bb : cfg.getVertices())
+			degrees += cfg.getPredecessors(bb).size() + cfg.getSuccessors(bb).size();
+		// every edge is seen once from each of its ends
+		EXPECT(degrees == 4 * (n - 1));
+		EXPECT(cfg.getPredecessors(bbs[0]).size() == n - 1);
+		EXPECT(cfg.getSuccessors(bbs[0]).size() == 1);
+		EXPECT(cfg.getPredecessors(bbs[n / 2]).size() == 1);
+		EXPECT(cfg.getSuccessors(bbs[n / 2]).size() == 2);
+	}
+
+	TEST(Utils, BitSet)
+	{
+		BitSet setA;
+		setA.insert(3);
+		setA.insert(64);
+		setA.insert(130);
+		EXPECT(setA.size() == 3);
+		EXPECT(setA.contains(64) && !setA.contains(65));
+
+		BitSet setB(256);
+		setB.insert(7);
+		setB.insert(200);
+		// differently sized sets compare by their elements only
+		BitSet setC = setA;
+		setC |= setB;
+		setC -= setB;
+		setB.erase(7);
+		setB.erase(200);
+		setB.insert(3);
+		setB.insert(64);
+		setB.insert(130);
+		EXPECT(setC == setA);
+		EXPECT(setB == setA);
+
+		setC &= setB;
+		EXPECT(setC.size() == 3);
+		setC -= setA;
+		EXPECT(setC.empty());
+
+		std::vector<size_t> ids;
+		setA.forEach([&](size_t id) { ids.push_back(id); });
+		EXPECT(ids == std::vector<size_t>({3, 64, 130}));
+
+		NodeManager manager;
+		auto type = manager.buildBasicType(Type::TI_Int);
+		analysis::numbering::VariableNumbering numbering;
+		VariableSet vars;
+		vars.insert(manager.buildVariable(type, "b"));
+		vars.insert(manager.buildVariable(type, "a"));
+		EXPECT(numbering.getId(manager.buildVariable(type, "b")) == 0);
+		auto bits = numbering.toBitSet(vars);
+		EXPECT(numbering.size() == 2 && bits.size() == 2);
+		auto back = numbering.toVariableSet(bits);
+		EXPECT(back.size() == 2 && (*back.begin())->getName() == "a");
+	}
+
 	TEST(Utils, PtrSet)
 	{
 		NodeManager manager;
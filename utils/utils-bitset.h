@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace utils {
+	// set of small dense integers packed into machine words, set operations
+	// process a whole word per step rather than a single element
+	class BitSet {
+	public:
+		typedef uint64_t word_type;
+		static constexpr size_t bitsPerWord = 64;
+
+		BitSet() {}
+		explicit BitSet(size_t size) : words((size + bitsPerWord - 1) / bitsPerWord) {}
+
+		// the set of all indices 0 .. size - 1
+		static BitSet full(size_t size) {
+			BitSet result(size);
+			std::fill(std::begin(result.words), std::end(result.words), ~word_type(0));
+			if (size % bitsPerWord) result.words.back() = mask(size) - 1;
+			return result;
+		}
+
+		void insert(size_t index) {
+			grow(index / bitsPerWord + 1);
+			words[index / bitsPerWord] |= mask(index);
+		}
+
+		void erase(size_t index) {
+			if (index / bitsPerWord < words.size())
+				words[index / bitsPerWord] &= ~mask(index);
+		}
+
+		bool contains(size_t index) const {
+			if (index / bitsPerWord >= words.size()) return false;
+			return (words[index / bitsPerWord] & mask(index)) != 0;
+		}
+
+		void clear() {
+			std::fill(std::begin(words), std::end(words), 0);
+		}
+
+		bool empty() const {
+			for (auto word : words) {
+				if (word) return false;
+			}
+			return true;
+		}
+
+		size_t size() const {
+			size_t result = 0;
+			for (auto word : words) result += __builtin_popcountll(word);
+			return result;
+		}
+
+		// union
+		BitSet& operator |=(const BitSet& other) {
+			grow(other.words.size());
+			for (size_t i = 0; i < other.words.size(); ++i) words[i] |= other.words[i];
+			return *this;
+		}
+
+		// intersection
+		BitSet& operator &=(const BitSet& other) {
+			size_t n = std::min(words.size(), other.words.size());
+			for (size_t i = 0; i < n; ++i) words[i] &= other.words[i];
+			std::fill(std::begin(words) + n, std::end(words), 0);
+			return *this;
+		}
+
+		// difference
+		BitSet& operator -=(const BitSet& other) {
+			size_t n = std::min(words.size(), other.words.size());
+			for (size_t i = 0; i < n; ++i) words[i] &= ~other.words[i];
+			return *this;
+		}
+
+		bool operator ==(const BitSet& other) const {
+			// sets of different capacity may still be equal, trailing words must be zero
+			const auto& lhs = words.size() < other.words.size() ? words : other.words;
+			const auto& rhs = words.size() < other.words.size() ? other.words : words;
+			for (size_t i = 0; i < lhs.size(); ++i) {
+				if (lhs[i] != rhs[i]) return false;
+			}
+			for (size_t i = lhs.size(); i < rhs.size(); ++i) {
+				if (rhs[i]) return false;
+			}
+			return true;
+		}
+
+		bool operator !=(const BitSet& other) const {
+			return !(*this == other);
+		}
+
+		// calls lambda for each index in the set in ascending order
+		template<typename TLambda>
+		void forEach(TLambda lambda) const {
+			for (size_t i = 0; i < words.size(); ++i) {
+				for (word_type word = words[i]; word; word &= word - 1)
+					lambda(i * bitsPerWord + __builtin_ctzll(word));
+			}
+		}
+	private:
+		static word_type mask(size_t index) {
+			return word_type(1) << (index % bitsPerWord);
+		}
+
+		void grow(size_t numberOfWords) {
+			if (words.size() < numberOfWords) words.resize(numberOfWords, 0);
+		}
+
+		std::vector<word_type> words;
+	};
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include "utils/utils-graph.h"
+#include "utils/utils-bitset.h"
+#include <set>
 
 namespace utils {
 namespace graph {
@@ -79,6 +81,356 @@ namespace color {
 		return result;
 	}
 
+	// interference graph as used by register allocation, vertices are numbered
+	// densely in the order of insertion. each edge is recorded in a triangular
+	// bit matrix for constant time queries and in adjacency vectors, thus
+	// the neighbours of a vertex are visited in O(degree). moves connect vertices
+	// which should preferably share the same color, the weight of a vertex is
+	// the cost of leaving it uncolored
+	template<typename TVertex>
+	class AllocationGraph {
+	public:
+		typedef Ptr<TVertex> vertex_type;
+		typedef PtrList<TVertex> vertex_list_type;
+
+		unsigned addVertex(const vertex_type& vertex) {
+			auto res = index.insert(std::make_pair(vertex, static_cast<unsigned>(vertices.size())));
+			if (!res.second) return res.first->second;
+			vertices.push_back(vertex);
+			adjacency.push_back({});
+			weights.push_back(1.0);
+			forbidden.push_back(0);
+			return res.first->second;
+		}
+
+		void addEdge(const vertex_type& source, const vertex_type& target) {
+			// number the source first, the order of arguments is unspecified
+			unsigned s = addVertex(source);
+			addEdge(s, addVertex(target));
+		}
+
+		void addEdge(unsigned source, unsigned target) {
+			if (source == target || hasEdge(source, target)) return;
+			matrix.insert(bit(source, target));
+			adjacency[source].push_back(target);
+			adjacency[target].push_back(source);
+		}
+
+		bool hasEdge(unsigned source, unsigned target) const {
+			return source != target && matrix.contains(bit(source, target));
+		}
+
+		void addMove(const vertex_type& source, const vertex_type& target) {
+			unsigned s = addVertex(source);
+			addMove(s, addVertex(target));
+		}
+
+		void addMove(unsigned source, unsigned target) {
+			if (source != target) moves.push_back(std::make_pair(source, target));
+		}
+
+		const std::vector<std::pair<unsigned, unsigned>>& getMoves() const { return moves; }
+		// drops each move the predicate holds for, e.g. to keep split ranges apart
+		template<typename Lambda>
+		void removeMoves(Lambda pred) {
+			moves.erase(std::remove_if(moves.begin(), moves.end(),
+				[&](const std::pair<unsigned, unsigned>& move) { return pred(move.first, move.second); }), moves.end());
+		}
+
+		void setWeight(unsigned vertex, double weight) { weights[vertex] = weight; }
+		double getWeight(unsigned vertex) const { return weights[vertex]; }
+
+		// the vertex must not receive the given color, e.g. as it is clobbered
+		void forbidColor(unsigned vertex, unsigned color) {
+			assert(color < 32 && "at most 32 colors can be forbidden");
+			forbidden[vertex] |= 1u << color;
+		}
+		bool isForbidden(unsigned vertex, unsigned color) const { return (forbidden[vertex] >> color) & 1u; }
+		unsigned getForbidden(unsigned vertex) const { return forbidden[vertex]; }
+
+		// -1 if the vertex is not part of the graph
+		int getIndex(const vertex_type& vertex) const {
+			auto it = index.find(vertex);
+			return it == index.end() ? -1 : static_cast<int>(it->second);
+		}
+
+		const vertex_type& getVertex(unsigned vertex) const { return vertices[vertex]; }
+		const vertex_list_type& getVertices() const { return vertices; }
+		const std::vector<unsigned>& getNeighbours(unsigned vertex) const { return adjacency[vertex]; }
+		unsigned getDegree(unsigned vertex) const { return adjacency[vertex].size(); }
+		size_t numberOfVertices() const { return vertices.size(); }
+		bool empty() const { return vertices.empty(); }
+
+		// a copy as general graph, e.g. to be printed
+		ColorGraph<TVertex> toColorGraph() const {
+			ColorGraph<TVertex> result;
+			for (unsigned i = 0; i < vertices.size(); ++i) {
+				result.addVertex(vertices[i]);
+				for (unsigned j : adjacency[i]) {
+					if (j < i) result.addEdge(vertices[i], vertices[j]);
+				}
+			}
+			return result;
+		}
+	private:
+		static size_t bit(size_t source, size_t target) {
+			if (source < target) std::swap(source, target);
+			return source * (source - 1) / 2 + target;
+		}
+
+		vertex_list_type vertices;
+		std::unordered_map<vertex_type, unsigned, target_hash<TVertex>, target_equal<TVertex>> index;
+		std::vector<std::vector<unsigned>> adjacency;
+		std::vector<std::pair<unsigned, unsigned>> moves;
+		std::vector<double> weights;
+		std::vector<unsigned> forbidden;
+		BitSet matrix;
+	};
+
+	// iterated register coalescing as described by George and Appel: simplify
+	// only removes vertices which are not move related, the ends of a move are
+	// merged as long as the briggs or george test guarantees that the graph
+	// stays k-colorable, otherwise the move is frozen. if all vertices are of
+	// significant degree, the one with the lowest weight per degree is spilled.
+	// the i-th mapping of the result belongs to the i-th vertex of the graph,
+	// coalesced vertices receive the color of the vertex they were merged into.
+	// forbidden colors are only considered while selecting, a vertex which runs
+	// out of colors that way is left uncolored like any other actual spill
+	template<typename TVertex, typename TColor = int>
+	Mappings<TVertex, TColor> getColorMappings(const AllocationGraph<TVertex>& graph, unsigned numberOfColors) {
+		Mappings<TVertex, TColor> result;
+		const unsigned n = graph.numberOfVertices();
+		for (unsigned i = 0; i < n; ++i) result.push_back({graph.getVertex(i), -1, false});
+		if (!numberOfColors || !n) return result;
+
+		enum NodeState { NS_Initial, NS_Simplify, NS_Freeze, NS_Spill, NS_Coalesced, NS_Stack };
+		enum MoveState { MS_Worklist, MS_Active, MS_Coalesced, MS_Constrained, MS_Frozen };
+		const unsigned k = numberOfColors;
+		// edges are added while merging vertices, hence work on a copy
+		AllocationGraph<TVertex> problem = graph;
+		const auto& moves = graph.getMoves();
+
+		std::vector<unsigned> degree(n);
+		std::vector<unsigned> alias(n);
+		std::vector<NodeState> state(n);
+		std::vector<std::vector<unsigned>> moveList(n);
+		std::vector<MoveState> moveState(moves.size(), MS_Worklist);
+		std::vector<unsigned> simplifyWorklist, freezeWorklist, worklistMoves, stack;
+		stack.reserve(n);
+		// number of vertices neither on the stack nor coalesced
+		unsigned remaining = n;
+
+		// spill candidates ordered by weight per degree, the cheapest one first.
+		// all of them have a degree of at least k, ties are broken by index
+		std::vector<double> weight(n);
+		std::vector<unsigned> forbidden(n);
+		struct Cheaper {
+			const std::vector<double>& weight;
+			const std::vector<unsigned>& degree;
+			bool operator()(unsigned lhs, unsigned rhs) const {
+				double l = weight[lhs] * degree[rhs], r = weight[rhs] * degree[lhs];
+				return l != r ? l < r : lhs < rhs;
+			}
+		};
+		std::set<unsigned, Cheaper> spillWorklist(Cheaper{ weight, degree });
+		// the key of a candidate must not change while it is part of the set,
+		// hence it is taken out while its degree or weight is updated
+		auto setDegree = [&](unsigned vertex, unsigned value) {
+			bool spill = state[vertex] == NS_Spill;
+			if (spill) spillWorklist.erase(vertex);
+			degree[vertex] = value;
+			// a vertex dropping below k leaves the candidates right after
+			if (spill && value >= k) spillWorklist.insert(vertex);
+		};
+		auto setWeight = [&](unsigned vertex, double value) {
+			bool spill = state[vertex] == NS_Spill;
+			if (spill) spillWorklist.erase(vertex);
+			weight[vertex] = value;
+			if (spill) spillWorklist.insert(vertex);
+		};
+		// the other worklists are only appended to, stale entries are skipped by state
+		auto setState = [&](unsigned vertex, NodeState next) {
+			if (state[vertex] == NS_Spill) spillWorklist.erase(vertex);
+			state[vertex] = next;
+			switch (next) {
+			case NS_Simplify: simplifyWorklist.push_back(vertex); break;
+			case NS_Freeze: freezeWorklist.push_back(vertex); break;
+			case NS_Spill: spillWorklist.insert(vertex); break;
+			case NS_Stack:
+			case NS_Coalesced: --remaining; break;
+			default: break;
+			}
+		};
+		auto isAdjacent = [&](unsigned vertex) {
+			return state[vertex] != NS_Stack && state[vertex] != NS_Coalesced;
+		};
+		auto isMoveRelated = [&](unsigned vertex) {
+			for (unsigned move : moveList[vertex]) {
+				if (moveState[move] == MS_Worklist || moveState[move] == MS_Active) return true;
+			}
+			return false;
+		};
+		auto getAlias = [&](unsigned vertex) {
+			while (state[vertex] == NS_Coalesced) vertex = alias[vertex];
+			return vertex;
+		};
+		auto enableMoves = [&](unsigned vertex) {
+			for (unsigned move : moveList[vertex]) {
+				if (moveState[move] != MS_Active) continue;
+				moveState[move] = MS_Worklist;
+				worklistMoves.push_back(move);
+			}
+		};
+		auto decrementDegree = [&](unsigned vertex) {
+			unsigned d = degree[vertex];
+			setDegree(vertex, d - 1);
+			if (d != k) return;
+			// the vertex became colorable, thus moves nearby may be coalesced now
+			enableMoves(vertex);
+			for (unsigned neighbour : problem.getNeighbours(vertex)) {
+				if (isAdjacent(neighbour)) enableMoves(neighbour);
+			}
+			setState(vertex, isMoveRelated(vertex) ? NS_Freeze : NS_Simplify);
+		};
+		auto addWorkList = [&](unsigned vertex) {
+			if (state[vertex] == NS_Freeze && !isMoveRelated(vertex) && degree[vertex] < k)
+				setState(vertex, NS_Simplify);
+		};
+		auto addEdge = [&](unsigned source, unsigned target) {
+			if (source == target || problem.hasEdge(source, target)) return;
+			problem.addEdge(source, target);
+			setDegree(source, degree[source] + 1);
+			setDegree(target, degree[target] + 1);
+		};
+		// george: each neighbour of v is either insignificant or already adjacent to u
+		auto george = [&](unsigned u, unsigned v) {
+			for (unsigned t : problem.getNeighbours(v)) {
+				if (isAdjacent(t) && degree[t] >= k && !problem.hasEdge(t, u)) return false;
+			}
+			return true;
+		};
+		// briggs: the merged vertex has less than k neighbours of significant degree
+		std::vector<unsigned> visited(n, 0);
+		unsigned stamp = 0;
+		auto briggs = [&](unsigned u, unsigned v) {
+			unsigned significant = 0;
+			++stamp;
+			for (unsigned w : { u, v }) {
+				for (unsigned t : problem.getNeighbours(w)) {
+					if (!isAdjacent(t) || visited[t] == stamp) continue;
+					visited[t] = stamp;
+					if (degree[t] >= k) ++significant;
+				}
+			}
+			return significant < k;
+		};
+		auto combine = [&](unsigned u, unsigned v) {
+			setState(v, NS_Coalesced);
+			alias[v] = u;
+			setWeight(u, weight[u] + weight[v]);
+			forbidden[u] |= forbidden[v];
+			moveList[u].insert(moveList[u].end(), moveList[v].begin(), moveList[v].end());
+			enableMoves(v);
+			// copy, as the neighbours of v may grow while adding edges
+			auto neighbours = problem.getNeighbours(v);
+			for (unsigned t : neighbours) {
+				if (!isAdjacent(t)) continue;
+				addEdge(t, u);
+				decrementDegree(t);
+			}
+			if (degree[u] >= k && state[u] == NS_Freeze) setState(u, NS_Spill);
+		};
+		auto freezeMoves = [&](unsigned u) {
+			for (unsigned move : moveList[u]) {
+				if (moveState[move] != MS_Worklist && moveState[move] != MS_Active) continue;
+				unsigned x = getAlias(moves[move].first), y = getAlias(moves[move].second);
+				unsigned v = (y == getAlias(u)) ? x : y;
+				moveState[move] = MS_Frozen;
+				addWorkList(v);
+			}
+		};
+
+		for (unsigned i = 0; i < moves.size(); ++i) {
+			moveList[moves[i].first].push_back(i);
+			moveList[moves[i].second].push_back(i);
+			worklistMoves.push_back(i);
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			alias[i] = i;
+			degree[i] = graph.getDegree(i);
+			weight[i] = graph.getWeight(i);
+			forbidden[i] = graph.getForbidden(i);
+			state[i] = NS_Initial;
+			if (degree[i] >= k) setState(i, NS_Spill);
+			else setState(i, isMoveRelated(i) ? NS_Freeze : NS_Simplify);
+		}
+
+		auto pop = [&](std::vector<unsigned>& worklist, NodeState expected, unsigned& vertex) {
+			while (!worklist.empty()) {
+				vertex = worklist.back();
+				worklist.pop_back();
+				if (state[vertex] == expected) return true;
+			}
+			return false;
+		};
+		while (remaining) {
+			unsigned vertex;
+			if (pop(simplifyWorklist, NS_Simplify, vertex)) {
+				setState(vertex, NS_Stack);
+				stack.push_back(vertex);
+				for (unsigned neighbour : problem.getNeighbours(vertex)) {
+					if (isAdjacent(neighbour)) decrementDegree(neighbour);
+				}
+			} else if (!worklistMoves.empty()) {
+				unsigned move = worklistMoves.back();
+				worklistMoves.pop_back();
+				if (moveState[move] != MS_Worklist) continue;
+				unsigned u = getAlias(moves[move].first), v = getAlias(moves[move].second);
+				if (u == v) {
+					moveState[move] = MS_Coalesced;
+					addWorkList(u);
+				} else if (problem.hasEdge(u, v)) {
+					moveState[move] = MS_Constrained;
+					addWorkList(u);
+					addWorkList(v);
+				} else if (george(u, v) || george(v, u) || briggs(u, v)) {
+					moveState[move] = MS_Coalesced;
+					combine(u, v);
+					addWorkList(u);
+				} else {
+					moveState[move] = MS_Active;
+				}
+			} else if (pop(freezeWorklist, NS_Freeze, vertex)) {
+				setState(vertex, NS_Simplify);
+				freezeMoves(vertex);
+			} else {
+				// no vertex v where |v|<k, spill the cheapest one relative to the
+				// number of neighbours it would free up a color for
+				vertex = *spillWorklist.begin();
+				result[vertex].flag = true;
+				setState(vertex, NS_Simplify);
+				freezeMoves(vertex);
+			}
+		}
+
+		// colorize the result -- pop in reverse order of removal
+		std::vector<bool> used(numberOfColors);
+		for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+			for (unsigned i = 0; i < used.size(); ++i) used[i] = (forbidden[*it] >> i) & 1u;
+			for (unsigned neighbour : problem.getNeighbours(*it)) {
+				int color = result[getAlias(neighbour)].color;
+				if (color >= 0) used[color] = true;
+			}
+			unsigned i = 0;
+			for (; i < used.size() && used[i]; ++i);
+			result[*it].color = i < used.size() ? i : -1;
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			if (state[i] == NS_Coalesced) result[i].color = result[getAlias(i)].color;
+		}
+		return result;
+	}
+
 	template<typename TVertex, typename TColor = int>
 	class ColorGraphPrinter : public GraphPrinter<TVertex, undirected> {
 		const Mappings<TVertex, TColor>& mappings;
@@ -10,79 +10,239 @@ namespace dominator {
 	template<typename TVertex>
 	using DominatorMap = std::unordered_map<typename Graph<TVertex>::vertex_type, DominatorSet<TVertex>>;
 
-	template<typename T, typename TVertex>
-	optional<TVertex> getImmediateDominator(const DominatorMap<T>& map, const TVertex& vertex) {
-		auto expected = map.at(vertex);
-		expected.erase(vertex);
-		for (const auto& pred : expected) {
-			if (map.at(pred) == expected) return pred;
+	// dominator tree of all vertices reachable from the first vertex of the graph,
+	// immediate dominators are computed by the iterative algorithm of Cooper,
+	// Harvey & Kennedy over reverse postorder numbers. each vertex is further
+	// annotated with pre- & postorder numbers of a dfs on the tree itself,
+	// which turns dominates(a, b) into two comparisons
+	template<typename TVertex>
+	class DominatorTree {
+	public:
+		typedef Graph<TVertex, directed> graph_type;
+		typedef typename graph_type::vertex_type vertex_type;
+		typedef typename graph_type::vertex_list_type vertex_list_type;
+
+		DominatorTree(const graph_type& graph);
+
+		const vertex_type& getRoot() const { return vertices[0]; }
+		bool isReachable(const vertex_type& vertex) const { return index(vertex) >= 0; }
+		optional<vertex_type> getImmediateDominator(const vertex_type& vertex) const;
+		const vertex_list_type& getChildren(const vertex_type& vertex) const;
+		// reflexive, every vertex dominates itself
+		bool dominates(const vertex_type& dominator, const vertex_type& vertex) const;
+		bool strictlyDominates(const vertex_type& dominator, const vertex_type& vertex) const;
+		DominatorSet<TVertex> getDominators(const vertex_type& vertex) const;
+		const vertex_list_type& getFrontier(const vertex_type& vertex) const;
+		// all reachable vertices in reverse postorder w.r.t. the graph
+		const vertex_list_type& getVertices() const { return vertices; }
+	private:
+		int index(const vertex_type& vertex) const;
+
+		// vertices in rpo, all vectors are indexed by the same number
+		vertex_list_type vertices;
+		std::unordered_map<vertex_type, unsigned,
+			typename graph_type::vertex_hash_type, typename graph_type::vertex_equal_type> numbers;
+		std::vector<unsigned> idoms;
+		std::vector<unsigned> pre;
+		std::vector<unsigned> post;
+		std::vector<vertex_list_type> children;
+		std::vector<vertex_list_type> frontiers;
+		vertex_list_type empty;
+	};
+
+	template<typename TVertex>
+	DominatorTree<TVertex>::DominatorTree(const graph_type& graph) {
+		if (graph.empty()) return;
+
+		// number all reachable vertices in reverse postorder using an explicit stack
+		vertex_list_type order;
+		{
+			std::unordered_map<vertex_type, bool, typename graph_type::vertex_hash_type,
+				typename graph_type::vertex_equal_type> visited;
+			std::vector<std::pair<vertex_type, vertex_list_type>> stack;
+			const auto& root = graph.getVertices().front();
+			visited[root] = true;
+			stack.push_back(std::make_pair(root, graph.getSuccessors(root)));
+			while (!stack.empty()) {
+				auto& succs = stack.back().second;
+				if (succs.empty()) {
+					order.push_back(stack.back().first);
+					stack.pop_back();
+					continue;
+				}
+				auto succ = succs.back();
+				succs.pop_back();
+				if (visited[succ]) continue;
+				visited[succ] = true;
+				stack.push_back(std::make_pair(succ, graph.getSuccessors(succ)));
+			}
 		}
-		return optional<TVertex>{};
-	}
+		vertices.assign(order.rbegin(), order.rend());
+		for (unsigned i = 0; i < vertices.size(); ++i)
+			numbers.insert(std::make_pair(vertices[i], i));
 
-	template<typename TGraph, typename T = typename TGraph::vertex_raw_type, typename TVertex = typename TGraph::vertex_type>
-	DominatorMap<T> getDominatorMap(const TGraph& graph) {
-		bool changed = true;
-		const auto& bbs = graph.getVertices();
-		DominatorMap<T> result;
-		// setup the initial map
-		result.insert(std::make_pair(bbs[0], DominatorSet<T>({bbs[0]})));
+		std::vector<std::vector<unsigned>> preds(vertices.size());
+		for (unsigned i = 0; i < vertices.size(); ++i) {
+			for (const auto& pred : graph.getPredecessors(vertices[i])) {
+				int p = index(pred);
+				if (p >= 0) preds[i].push_back(p);
+			}
+		}
 
-		DominatorSet<T> all(bbs.begin(), bbs.end());
-		std::for_each(bbs.begin()+1, bbs.end(), [&](const TVertex& bb) {
-			result.insert(std::make_pair(bb, all));
-		});
+		// as rpo numbers are used, the walk towards the root decreases them
+		const unsigned undefined = vertices.size();
+		auto intersect = [&](unsigned lhs, unsigned rhs) {
+			while (lhs != rhs) {
+				while (lhs > rhs) lhs = idoms[lhs];
+				while (rhs > lhs) rhs = idoms[rhs];
+			}
+			return lhs;
+		};
+
+		idoms.assign(vertices.size(), undefined);
+		idoms[0] = 0;
+		bool changed = true;
 		while (changed) {
 			changed = false;
-			std::for_each(bbs.begin(), bbs.end(), [&](const TVertex& bb) {
-				auto preds = graph.getPredecessors(bb);
-				if (preds.empty()) return;
+			for (unsigned i = 1; i < vertices.size(); ++i) {
+				unsigned idom = undefined;
+				for (unsigned pred : preds[i]) {
+					if (idoms[pred] == undefined) continue;
+					idom = (idom == undefined) ? pred : intersect(pred, idom);
+				}
+				if (idoms[i] != idom) {
+					idoms[i] = idom;
+					changed = true;
+				}
+			}
+		}
 
-				auto fst = result[preds[0]];
-				DominatorSet<T> cur(fst.begin(), fst.end());
+		children.resize(vertices.size());
+		for (unsigned i = 1; i < vertices.size(); ++i)
+			children[idoms[i]].push_back(vertices[i]);
 
-				std::for_each(preds.begin()+1, preds.end(), [&](const TVertex& pred) {
-					cur = algorithm::set_intersection(cur, result[pred]);
-				});
+		// pre- & postorder numbering of the tree
+		pre.resize(vertices.size());
+		post.resize(vertices.size());
+		{
+			unsigned preCount = 0, postCount = 0;
+			std::vector<std::pair<unsigned, unsigned>> stack;
+			pre[0] = preCount++;
+			stack.push_back(std::make_pair(0, 0));
+			while (!stack.empty()) {
+				auto& frame = stack.back();
+				if (frame.second < children[frame.first].size()) {
+					unsigned child = numbers.at(children[frame.first][frame.second++]);
+					pre[child] = preCount++;
+					stack.push_back(std::make_pair(child, 0));
+				} else {
+					post[frame.first] = postCount++;
+					stack.pop_back();
+				}
+			}
+		}
 
-				cur.insert(bb);
-				if (result[bb] != cur) {
-					result[bb] = cur;
-					changed = true;
+		// frontiers: walk up from each predecessor of a join point to its idom
+		frontiers.resize(vertices.size());
+		for (unsigned i = 0; i < vertices.size(); ++i) {
+			if (preds[i].size() < 2) continue;
+			for (unsigned pred : preds[i]) {
+				unsigned runner = pred;
+				while (runner != idoms[i]) {
+					auto& frontier = frontiers[runner];
+					if (frontier.empty() || frontier.back() != vertices[i])
+						frontier.push_back(vertices[i]);
+					if (runner == 0) break;
+					runner = idoms[runner];
 				}
-			});
+			}
 		}
-		return result;
 	}
 
-	template<typename TGraph, typename T = typename TGraph::vertex_raw_type, typename TVertex = typename TGraph::vertex_type>
-	DominatorMap<T> getDominatorFrontierMap(const TGraph& graph, const DominatorMap<T>& dominators) {
-		DominatorMap<T> result;
-		// increases the complexity to 2N but makes handling in real algo easier
-		for (const auto& bb: graph.getVertices()) {
-			result.insert(std::make_pair(bb, DominatorSet<T>{}));
-		}
+	template<typename TVertex>
+	int DominatorTree<TVertex>::index(const vertex_type& vertex) const {
+		auto it = numbers.find(vertex);
+		if (it == numbers.end()) return -1;
+		return it->second;
+	}
 
-		for (const auto& bb: graph.getVertices()) {
-			auto preds = graph.getPredecessors(bb);
-			// only consider bbs which are actually a merge of branches
-			if (preds.size() < 2) continue;
+	template<typename TVertex>
+	optional<typename DominatorTree<TVertex>::vertex_type> DominatorTree<TVertex>::getImmediateDominator(const vertex_type& vertex) const {
+		int i = index(vertex);
+		if (i <= 0) return {};
+		return vertices[idoms[i]];
+	}
+
+	template<typename TVertex>
+	const typename DominatorTree<TVertex>::vertex_list_type& DominatorTree<TVertex>::getChildren(const vertex_type& vertex) const {
+		int i = index(vertex);
+		if (i < 0) return empty;
+		return children[i];
+	}
+
+	template<typename TVertex>
+	bool DominatorTree<TVertex>::dominates(const vertex_type& dominator, const vertex_type& vertex) const {
+		int d = index(dominator);
+		int v = index(vertex);
+		if (d < 0 || v < 0) return false;
+		return pre[d] <= pre[v] && post[v] <= post[d];
+	}
 
-			auto idom = getImmediateDominator(dominators, bb);
-			// omit optional check as only root has no dominator and hence preds of 0!
+	template<typename TVertex>
+	bool DominatorTree<TVertex>::strictlyDominates(const vertex_type& dominator, const vertex_type& vertex) const {
+		return index(dominator) != index(vertex) && dominates(dominator, vertex);
+	}
 
-			for (const auto& pred: preds) {
-				auto runner = pred;
-				while (runner != *idom) {
-					result[runner].insert(bb);
+	template<typename TVertex>
+	DominatorSet<TVertex> DominatorTree<TVertex>::getDominators(const vertex_type& vertex) const {
+		DominatorSet<TVertex> result;
+		int i = index(vertex);
+		if (i < 0) return result;
+		for (; i > 0; i = idoms[i]) result.insert(vertices[i]);
+		result.insert(vertices[0]);
+		return result;
+	}
 
-					auto next = getImmediateDominator(dominators, runner);
-					if (!next) break;
+	template<typename TVertex>
+	const typename DominatorTree<TVertex>::vertex_list_type& DominatorTree<TVertex>::getFrontier(const vertex_type& vertex) const {
+		int i = index(vertex);
+		if (i < 0) return empty;
+		return frontiers[i];
+	}
 
-					// not it is save to prepare the next iteration
-					runner = *next;
-				}
-			}
+	template<typename T, typename TVertex>
+	optional<TVertex> getImmediateDominator(const DominatorMap<T>& map, const TVertex& vertex) {
+		auto expected = map.at(vertex);
+		expected.erase(vertex);
+		for (const auto& pred : expected) {
+			if (map.at(pred) == expected) return pred;
+		}
+		return optional<TVertex>{};
+	}
+
+	template<typename TGraph, typename T = typename TGraph::vertex_raw_type>
+	DominatorMap<T> getDominatorMap(const DominatorTree<T>& tree, const TGraph& graph) {
+		DominatorMap<T> result;
+		for (const auto& bb : graph.getVertices()) {
+			// unreachable vertices are only dominated by themselves
+			auto dominators = tree.getDominators(bb);
+			if (dominators.empty()) dominators.insert(bb);
+			result.insert(std::make_pair(bb, dominators));
+		}
+		return result;
+	}
+
+	template<typename TGraph, typename T = typename TGraph::vertex_raw_type>
+	DominatorMap<T> getDominatorMap(const TGraph& graph) {
+		return getDominatorMap(DominatorTree<T>(graph), graph);
+	}
+
+	template<typename TGraph, typename T = typename TGraph::vertex_raw_type>
+	DominatorMap<T> getDominatorFrontierMap(const DominatorTree<T>& tree, const TGraph& graph) {
+		DominatorMap<T> result;
+		for (const auto& bb: graph.getVertices()) {
+			const auto& frontier = tree.getFrontier(bb);
+			result.insert(std::make_pair(bb, DominatorSet<T>(frontier.begin(), frontier.end())));
 		}
 		return result;
 	}
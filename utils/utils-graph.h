@@ -2,6 +2,7 @@
 #include "utils/utils-printable.h"
 #include "utils/utils-container.h"
 #include <unordered_map>
+#include <unordered_set>
 
 namespace utils {
 	struct directed {};
@@ -83,6 +84,26 @@ namespace utils {
 	}
 
 	namespace detail {
+		template<typename TVertex, typename TDirection>
+		struct edge_hash;
+
+		template<typename TVertex>
+		struct edge_hash<TVertex, directed> {
+			size_t operator()(const Ptr<Edge<TVertex, directed>>& edge) const {
+				target_hash<TVertex> hash;
+				return combine_hash(hash(edge->getSource()), hash(edge->getTarget()));
+			}
+		};
+
+		template<typename TVertex>
+		struct edge_hash<TVertex, undirected> {
+			size_t operator()(const Ptr<Edge<TVertex, undirected>>& edge) const {
+				target_hash<TVertex> hash;
+				// must not depend on the order of src & dst as (a, b) == (b, a)
+				return hash(edge->getSource()) + hash(edge->getTarget());
+			}
+		};
+
 		template<typename TVertex, typename TDirection>
 		class GraphBase {
 		public:
@@ -90,14 +111,20 @@ namespace utils {
 			typedef Ptr<vertex_raw_type> vertex_type;
 			typedef PtrList<TVertex> vertex_list_type;
 			typedef target_equal<TVertex> vertex_equal_type;
+			typedef target_hash<TVertex> vertex_hash_type;
 			typedef Edge<TVertex, TDirection> edge_raw_type;
 			typedef Ptr<edge_raw_type> edge_type;
 			typedef PtrList<edge_raw_type> edge_list_type;
 			typedef target_equal<edge_raw_type> edge_equal_type;
+			typedef edge_hash<TVertex, TDirection> edge_hash_type;
 
 			bool addVertex(const vertex_type& vertex);
 			bool addEdge(const vertex_type& source, const vertex_type& target);
 			bool removeVertex(const vertex_type& vertex);
+			bool removeEdge(const vertex_type& source, const vertex_type& target);
+
+			bool hasVertex(const vertex_type& vertex) const;
+			bool hasEdge(const vertex_type& source, const vertex_type& target) const;
 
 			size_t numberOfVertices() const;
 			size_t numberOfEdges() const;
@@ -112,23 +139,34 @@ namespace utils {
 			template<typename TLambda>
 			edge_list_type findEdges(TLambda lambda) const;
 
-			edge_list_type& getEdges() { return edges; }
+			// both lists are read-only as the adjacency index has to be kept in sync,
+			// use addVertex, addEdge, removeVertex and removeEdge in order to modify the graph
 			const edge_list_type& getEdges() const { return edges; }
-			vertex_list_type& getVertices() { return vertices; }
 			const vertex_list_type& getVertices() const { return vertices; }
+		protected:
+			// every edge is recorded twice: as outgoing one of its source and as
+			// incoming one of its target, undirected graphs merge both on demand
+			struct Adjacency {
+				edge_list_type in;
+				edge_list_type out;
+			};
+
+			const Adjacency* getAdjacency(const vertex_type& vertex) const;
+			bool equals(const GraphBase<TVertex, TDirection>& other) const;
 		private:
+			static void unlink(edge_list_type& list, const edge_type& edge);
+
 			edge_list_type edges;
 			vertex_list_type vertices;
+			// hashed membership of vertices & edges, each vertex is mapped to its adjacency
+			std::unordered_map<vertex_type, Adjacency, vertex_hash_type, vertex_equal_type> adjacency;
+			std::unordered_set<edge_type, edge_hash_type, edge_equal_type> edgeSet;
 		};
 
 		template<typename TVertex, typename TDirection>
 		bool GraphBase<TVertex, TDirection>::addVertex(const vertex_type& vertex) {
-			vertex_equal_type cmp;
-
-			auto it = std::find_if(std::begin(vertices), std::end(vertices),
-				[&](const vertex_type& e) { return cmp(vertex, e); });
 			// dont insert twice
-			if (it != std::end(vertices)) return false;
+			if (!adjacency.emplace(vertex, Adjacency()).second) return false;
 
 			vertices.push_back(vertex);
 			return true;
@@ -136,35 +174,97 @@ namespace utils {
 
 		template<typename TVertex, typename TDirection>
 		bool GraphBase<TVertex, TDirection>::addEdge(const vertex_type& source, const vertex_type& target) {
-			edge_equal_type cmp;
-
 			addVertex(source);
 			addVertex(target);
 
 			auto edge = makeEdge<TVertex, TDirection>(source, target);
-			auto it = std::find_if(std::begin(edges), std::end(edges),
-				[&](const edge_type& e) { return cmp(edge, e); });
 			// dont insert twice
-			if (it != std::end(edges)) return false;
+			if (!edgeSet.insert(edge).second) return false;
 
 			edges.push_back(edge);
+			adjacency.find(source)->second.out.push_back(edge);
+			adjacency.find(target)->second.in.push_back(edge);
 			return true;
 		}
 
+		template<typename TVertex, typename TDirection>
+		void GraphBase<TVertex, TDirection>::unlink(edge_list_type& list, const edge_type& edge) {
+			auto it = std::find(std::begin(list), std::end(list), edge);
+			if (it != std::end(list)) list.erase(it);
+		}
+
 		template<typename TVertex, typename TDirection>
 		bool GraphBase<TVertex, TDirection>::removeVertex(const vertex_type& vertex) {
+			auto adj = adjacency.find(vertex);
+			if (adj == std::end(adjacency)) return false;
+
 			vertex_equal_type cmp;
-			for (auto it = std::begin(getEdges()); it != std::end(getEdges());) {
-				auto edge = *it;
-				if (cmp(edge->getSource(), vertex) || cmp(edge->getTarget(), vertex))
-					it = edges.erase(it);
-				else
-					std::advance(it, 1);
+			// detach all connected edges from the adjacency of our neighbours
+			for (const auto& edge : adj->second.in) {
+				if (!cmp(edge->getSource(), vertex))
+					unlink(adjacency.find(edge->getSource())->second.out, edge);
+				edgeSet.erase(edge);
+			}
+			for (const auto& edge : adj->second.out) {
+				if (!cmp(edge->getTarget(), vertex))
+					unlink(adjacency.find(edge->getTarget())->second.in, edge);
+				edgeSet.erase(edge);
 			}
-			auto it = std::find_if(std::begin(getVertices()), std::end(getVertices()),
+			if (!adj->second.in.empty() || !adj->second.out.empty()) {
+				edges.erase(std::remove_if(std::begin(edges), std::end(edges),
+					[&](const edge_type& edge) {
+						return cmp(edge->getSource(), vertex) || cmp(edge->getTarget(), vertex);
+					}), std::end(edges));
+			}
+			adjacency.erase(adj);
+
+			auto it = std::find_if(std::begin(vertices), std::end(vertices),
 				[&](const vertex_type& element) { return cmp(element, vertex); });
-			if (it == std::end(getVertices())) return false;
-			getVertices().erase(it);
+			vertices.erase(it);
+			return true;
+		}
+
+		template<typename TVertex, typename TDirection>
+		bool GraphBase<TVertex, TDirection>::removeEdge(const vertex_type& source, const vertex_type& target) {
+			auto it = edgeSet.find(makeEdge<TVertex, TDirection>(source, target));
+			if (it == std::end(edgeSet)) return false;
+
+			// the stored edge may be the reversed one of an undirected graph
+			auto edge = *it;
+			edgeSet.erase(it);
+			unlink(adjacency.find(edge->getSource())->second.out, edge);
+			unlink(adjacency.find(edge->getTarget())->second.in, edge);
+			unlink(edges, edge);
+			return true;
+		}
+
+		template<typename TVertex, typename TDirection>
+		bool GraphBase<TVertex, TDirection>::hasVertex(const vertex_type& vertex) const {
+			return adjacency.find(vertex) != std::end(adjacency);
+		}
+
+		template<typename TVertex, typename TDirection>
+		bool GraphBase<TVertex, TDirection>::hasEdge(const vertex_type& source, const vertex_type& target) const {
+			return edgeSet.find(makeEdge<TVertex, TDirection>(source, target)) != std::end(edgeSet);
+		}
+
+		template<typename TVertex, typename TDirection>
+		const typename GraphBase<TVertex, TDirection>::Adjacency* GraphBase<TVertex, TDirection>::getAdjacency(const vertex_type& vertex) const {
+			auto it = adjacency.find(vertex);
+			if (it == std::end(adjacency)) return nullptr;
+			return &it->second;
+		}
+
+		template<typename TVertex, typename TDirection>
+		bool GraphBase<TVertex, TDirection>::equals(const GraphBase<TVertex, TDirection>& other) const {
+			if (numberOfVertices() != other.numberOfVertices()) return false;
+			if (numberOfEdges() != other.numberOfEdges()) return false;
+			for (const auto& vertex : vertices) {
+				if (!other.hasVertex(vertex)) return false;
+			}
+			for (const auto& edge : edges) {
+				if (other.edgeSet.find(edge) == std::end(other.edgeSet)) return false;
+			}
 			return true;
 		}
 
@@ -220,30 +320,6 @@ namespace utils {
 			}
 			return result;
 		}
-
-		template<typename TVertex, typename TDirection, typename TGraph = Graph<TVertex, TDirection>>
-		bool equals_unordered(const typename TGraph::vertex_list_type& fst, const typename TGraph::vertex_list_type& snd) {
-			if (fst.size() != snd.size()) return false;
-			typename TGraph::vertex_equal_type cmp;
-			for (const auto& vertex : fst) {
-				auto it = std::find_if(std::cbegin(snd), std::cend(snd),
-					[&](const typename TGraph::vertex_type& other) { return cmp(vertex, other); });
-				if (it == std::cend(snd)) return false;
-			}
-			return true;
-		}
-
-		template<typename TVertex, typename TDirection, typename TGraph = Graph<TVertex, TDirection>>
-		bool equals_unordered(const typename TGraph::edge_list_type& fst, const typename TGraph::edge_list_type& snd) {
-			if (fst.size() != snd.size()) return false;
-			typename TGraph::edge_equal_type cmp;
-			for (const auto& edge : fst) {
-				auto it = std::find_if(std::cbegin(snd), std::cend(snd),
-					[&](const typename TGraph::edge_type& other) { return cmp(edge, other); });
-				if (it == std::cend(snd)) return false;
-			}
-			return true;
-		}
 	}
 
 	template<typename TVertex, typename TDirection>
@@ -257,15 +333,17 @@ namespace utils {
 		typename graph_type::edge_list_type getConnectedEdges(const typename graph_type::vertex_type& vertex, Direction dir) const {
 			typename graph_type::vertex_equal_type cmp;
 			typename graph_type::edge_list_type result;
-			for (const auto& edge : this->getEdges()) {
-				if ((dir == Direction::IN || dir == Direction::ANY) && cmp(edge->getTarget(), vertex)) {
-					result.push_back(edge);
-					continue;
-				}
+			auto adj = this->getAdjacency(vertex);
+			if (!adj) return result;
 
-				if ((dir == Direction::OUT || dir == Direction::ANY) && cmp(edge->getSource(), vertex)) {
+			if (dir == Direction::IN || dir == Direction::ANY)
+				result.insert(std::end(result), std::begin(adj->in), std::end(adj->in));
+
+			if (dir == Direction::OUT || dir == Direction::ANY) {
+				for (const auto& edge : adj->out) {
+					// self loops have already been reported as incoming edge
+					if (dir == Direction::ANY && cmp(edge->getTarget(), vertex)) continue;
 					result.push_back(edge);
-					continue;
 				}
 			}
 			return result;
@@ -288,8 +366,7 @@ namespace utils {
 		}
 
 		bool operator ==(const Graph<TVertex, directed>& other) const {
-			return detail::equals_unordered<TVertex, directed>(this->getVertices(), other.getVertices()) &&
-						 detail::equals_unordered<TVertex, directed>(this->getEdges(), other.getEdges());
+			return this->equals(other);
 		}
 
 		bool operator !=(const Graph<TVertex, directed>& other) const {
@@ -306,29 +383,35 @@ namespace utils {
 
 		typename graph_type::edge_list_type getConnectedEdges(const typename graph_type::vertex_type& vertex) const {
 			typename graph_type::vertex_equal_type cmp;
-			return this->findEdges([&](const typename graph_type::edge_type& edge) {
-				return cmp(edge->getSource(), vertex) || cmp(edge->getTarget(), vertex);
-			});
+			typename graph_type::edge_list_type result;
+			auto adj = this->getAdjacency(vertex);
+			if (!adj) return result;
+
+			result.insert(std::end(result), std::begin(adj->out), std::end(adj->out));
+			for (const auto& edge : adj->in) {
+				// self loops have already been reported as outgoing edge
+				if (!cmp(edge->getSource(), vertex)) result.push_back(edge);
+			}
+			return result;
 		}
 
 		typename graph_type::vertex_list_type getConnectedVertices(const typename graph_type::vertex_type& vertex) const {
 			typename graph_type::vertex_equal_type cmp;
 			typename graph_type::vertex_list_type result;
-			this->findEdges([&](const typename graph_type::edge_type& edge) {
-				bool src = cmp(edge->getSource(), vertex);
-				bool dst = cmp(edge->getTarget(), vertex);
-				if (!src && !dst) return false;
-				// in order to cope with vertices which build a cycle with themselfs!
-				if (!src) result.push_back(edge->getSource());
-				else if (!dst) result.push_back(edge->getTarget());
-				return false;
-			});
+			auto adj = this->getAdjacency(vertex);
+			if (!adj) return result;
+			// in order to cope with vertices which build a cycle with themselfs!
+			for (const auto& edge : adj->out) {
+				if (!cmp(edge->getTarget(), vertex)) result.push_back(edge->getTarget());
+			}
+			for (const auto& edge : adj->in) {
+				if (!cmp(edge->getSource(), vertex)) result.push_back(edge->getSource());
+			}
 			return result;
 		}
 
 		bool operator ==(const Graph<TVertex, undirected>& other) const {
-			return detail::equals_unordered<TVertex, undirected>(this->getVertices(), other.getVertices()) &&
-						 detail::equals_unordered<TVertex, undirected>(this->getEdges(), other.getEdges());
+			return this->equals(other);
 		}
 
 		bool operator !=(const Graph<TVertex, undirected>& other) const {
@@ -2,6 +2,7 @@
 #include <cstdio>
 #include <cmath>
 #include <algorithm>
+#include <numeric>
 #include <fstream>
 #include <sstream>
 #include <iterator>